@@ -0,0 +1,215 @@
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory_resource>
+#include <random>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <adbus/protocol/dbus_value.hpp>
+#include <adbus/protocol/header_view.hpp>
+#include <adbus/protocol/message_header.hpp>
+#include <adbus/protocol/read.hpp>
+#include <adbus/protocol/write.hpp>
+
+#ifdef ADBUS_BENCH_LIBDBUS
+#include <dbus/dbus.h>
+#endif
+
+// A org.freedesktop.DBus.Properties.GetAll reply of 64 properties, decoded into the dynamic dbus_value tree, into the
+// matching static type and, when libdbus is found, walked with DBusMessageIter. Every value of the reply is visited.
+// The same for a reply holding an array of doubles, which the tree keeps as a single node.
+
+namespace header = adbus::protocol::header;
+
+namespace {
+
+constexpr std::uint32_t seed{ 1337 };
+
+using variant_t = std::variant<std::string, std::uint32_t, double, bool>;
+using properties_t = std::map<std::string, variant_t>;
+
+auto random_string(std::mt19937& rng, std::size_t length) -> std::string {
+  std::uniform_int_distribution<int> dist{ 'a', 'z' };
+  std::string output(length, '\0');
+  for (auto& c : output) {
+    c = static_cast<char>(dist(rng));
+  }
+  return output;
+}
+
+auto make_reply() -> std::string {
+  std::mt19937 rng{ seed };
+  properties_t properties{};
+  std::uniform_int_distribution<std::size_t> alternative{ 0, std::variant_size_v<variant_t> - 1 };
+  while (properties.size() < 64) {
+    variant_t value{};
+    switch (alternative(rng)) {
+      case 0:
+        value = random_string(rng, 24);
+        break;
+      case 1:
+        value = static_cast<std::uint32_t>(rng());
+        break;
+      case 2:
+        value = std::uniform_real_distribution<double>{ -1e6, 1e6 }(rng);
+        break;
+      default:
+        value = rng() % 2 == 0;
+        break;
+    }
+    properties.emplace(random_string(rng, 12), std::move(value));
+  }
+  header::header const hdr{ .type = header::message_type_e::method_return,
+                            .serial = 2,
+                            .fields = {
+                                { header::field_reply_serial{ 1 } },
+                                { header::field_signature{ std::string_view{ "a{sv}" } } },
+                            } };
+  return adbus::protocol::write_dbus_message(hdr, properties).value();
+}
+
+auto make_array_reply() -> std::string {
+  std::mt19937 rng{ seed };
+  std::vector<double> samples(4096);
+  for (auto& sample : samples) {
+    sample = std::uniform_real_distribution<double>{ -1e6, 1e6 }(rng);
+  }
+  header::header const hdr{ .type = header::message_type_e::method_return,
+                            .serial = 2,
+                            .fields = {
+                                { header::field_reply_serial{ 1 } },
+                                { header::field_signature{ std::string_view{ "ad" } } },
+                            } };
+  return adbus::protocol::write_dbus_message(hdr, samples).value();
+}
+
+// Visits every value below node, returns the number of values which are not containers
+auto walk(adbus::protocol::dbus_value const& node) -> std::size_t {
+  std::size_t leaves{};
+  node.visit([&](auto const& value) {
+    if constexpr (std::same_as<std::decay_t<decltype(value)>, adbus::protocol::dbus_value>) {
+      if (value.is_fixed_array() && value.signature() == "ad") {
+        for (std::size_t idx{}; idx < value.size(); ++idx) {
+          benchmark::DoNotOptimize(value.template element<double>(idx));
+        }
+        leaves += value.size();
+      }
+      for (auto const& child : value.children()) {
+        leaves += walk(child);
+      }
+    } else {
+      benchmark::DoNotOptimize(value);
+      ++leaves;
+    }
+  });
+  return leaves;
+}
+
+void bm_dbus_value(benchmark::State& state, std::string (*make)()) {
+  auto const message{ make() };
+  auto const view{ header::header_view::make(message).value() };
+  // the nodes of one reply fit, so the arena never allocates after the first iteration
+  std::array<std::byte, 64 * 1024> buffer{};
+  std::pmr::monotonic_buffer_resource arena{ buffer.data(), buffer.size() };
+  for (auto _ : state) {
+    auto root{ adbus::protocol::parse_dbus_value(view, &arena) };
+    benchmark::DoNotOptimize(walk(**root));
+    arena.release();
+  }
+  state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * view.body().size()));
+}
+BENCHMARK_CAPTURE(bm_dbus_value, properties, &make_reply);
+BENCHMARK_CAPTURE(bm_dbus_value, doubles, &make_array_reply);
+
+// The static type, for reference, the variant alternatives are matched by signature
+void bm_static_type(benchmark::State& state) {
+  auto const message{ make_reply() };
+  auto const view{ header::header_view::make(message).value() };
+  for (auto _ : state) {
+    auto properties{ adbus::protocol::read_dbus_binary<properties_t>(view.body()) };
+    benchmark::DoNotOptimize(properties);
+  }
+  state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * view.body().size()));
+}
+BENCHMARK(bm_static_type);
+
+#ifdef ADBUS_BENCH_LIBDBUS
+auto walk(DBusMessageIter& iter) -> std::size_t {
+  std::size_t leaves{};
+  for (int type{}; (type = dbus_message_iter_get_arg_type(&iter)) != DBUS_TYPE_INVALID; dbus_message_iter_next(&iter)) {
+    if (type == DBUS_TYPE_ARRAY && dbus_message_iter_get_element_type(&iter) == DBUS_TYPE_DOUBLE) {
+      // the elements of an array of doubles are read in one go, as with dbus_value
+      DBusMessageIter sub{};
+      dbus_message_iter_recurse(&iter, &sub);
+      double const* elements{};
+      int count{};
+      dbus_message_iter_get_fixed_array(&sub, static_cast<void*>(&elements), &count);
+      for (int idx{}; idx < count; ++idx) {
+        benchmark::DoNotOptimize(elements[idx]);
+      }
+      leaves += static_cast<std::size_t>(count);
+    } else if (dbus_type_is_container(type)) {
+      DBusMessageIter sub{};
+      dbus_message_iter_recurse(&iter, &sub);
+      leaves += walk(sub);
+    } else {
+      DBusBasicValue value{};
+      dbus_message_iter_get_basic(&iter, &value);
+      benchmark::DoNotOptimize(value);
+      ++leaves;
+    }
+  }
+  return leaves;
+}
+
+// Iteration only, the message is demarshalled and validated once
+void bm_libdbus_iter(benchmark::State& state, std::string (*make)()) {
+  auto const message{ make() };
+  DBusError err{};
+  dbus_error_init(&err);
+  auto* msg{ dbus_message_demarshal(message.data(), static_cast<int>(message.size()), &err) };
+  if (msg == nullptr) {
+    state.SkipWithError(err.message);
+    dbus_error_free(&err);
+    return;
+  }
+  for (auto _ : state) {
+    DBusMessageIter iter{};
+    dbus_message_iter_init(msg, &iter);
+    benchmark::DoNotOptimize(walk(iter));
+  }
+  dbus_message_unref(msg);
+}
+BENCHMARK_CAPTURE(bm_libdbus_iter, properties, &make_reply);
+BENCHMARK_CAPTURE(bm_libdbus_iter, doubles, &make_array_reply);
+
+// Demarshalling, which validates the whole message, and iteration, comparable to bm_dbus_value
+void bm_libdbus_demarshal_iter(benchmark::State& state, std::string (*make)()) {
+  auto const message{ make() };
+  for (auto _ : state) {
+    DBusError err{};
+    dbus_error_init(&err);
+    auto* msg{ dbus_message_demarshal(message.data(), static_cast<int>(message.size()), &err) };
+    if (msg == nullptr) {
+      state.SkipWithError(err.message);
+      dbus_error_free(&err);
+      return;
+    }
+    DBusMessageIter iter{};
+    dbus_message_iter_init(msg, &iter);
+    benchmark::DoNotOptimize(walk(iter));
+    dbus_message_unref(msg);
+  }
+}
+BENCHMARK_CAPTURE(bm_libdbus_demarshal_iter, properties, &make_reply);
+BENCHMARK_CAPTURE(bm_libdbus_demarshal_iter, doubles, &make_array_reply);
+#endif
+
+}  // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,249 @@
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <adbus/protocol/message_header.hpp>
+#include <adbus/protocol/read.hpp>
+#include <adbus/protocol/write.hpp>
+
+#include "common.hpp"
+
+// Every benchmark seeds its own generator with the same value so the payloads, and therefore the numbers, are
+// comparable between runs and between releases.
+static constexpr std::uint32_t seed{ 1337 };
+
+namespace header = adbus::protocol::header;
+
+using variant_t = std::variant<std::string, std::uint32_t, double, bool>;
+using properties_t = std::map<std::string, variant_t>;
+
+auto random_string(std::mt19937& rng, std::size_t length) -> std::string {
+  std::uniform_int_distribution<int> dist{ 'a', 'z' };
+  std::string output(length, '\0');
+  for (auto& c : output) {
+    c = static_cast<char>(dist(rng));
+  }
+  return output;
+}
+
+auto make_uint64(std::mt19937& rng) -> std::uint64_t {
+  return std::uniform_int_distribution<std::uint64_t>{}(rng);
+}
+
+auto make_double(std::mt19937& rng) -> double {
+  return std::uniform_real_distribution<double>{ -1e6, 1e6 }(rng);
+}
+
+auto make_string(std::mt19937& rng) -> std::string {
+  return random_string(rng, 64);
+}
+
+auto make_foos(std::mt19937& rng) -> std::vector<foo> {
+  std::vector<foo> output(64);
+  for (auto& f : output) {
+    f.a = make_uint64(rng);
+    f.b = random_string(rng, 16);
+    for (std::size_t i{}; i < 4; ++i) {
+      f.bars.push_back({ .a = random_string(rng, 8), .b = make_uint64(rng) });
+      f.bars2.push_back({ .a = random_string(rng, 12), .b = make_uint64(rng) });
+    }
+  }
+  return output;
+}
+
+auto make_map(std::mt19937& rng) -> std::map<std::string, std::uint64_t> {
+  std::map<std::string, std::uint64_t> output{};
+  while (output.size() < 64) {
+    output.emplace(random_string(rng, 12), make_uint64(rng));
+  }
+  return output;
+}
+
+auto make_properties(std::mt19937& rng) -> properties_t {
+  properties_t output{};
+  std::uniform_int_distribution<std::size_t> alternative{ 0, std::variant_size_v<variant_t> - 1 };
+  while (output.size() < 64) {
+    variant_t value{};
+    switch (alternative(rng)) {
+      case 0:
+        value = random_string(rng, 24);
+        break;
+      case 1:
+        value = static_cast<std::uint32_t>(make_uint64(rng));
+        break;
+      case 2:
+        value = make_double(rng);
+        break;
+      default:
+        value = make_uint64(rng) % 2 == 0;
+        break;
+    }
+    output.emplace(random_string(rng, 12), std::move(value));
+  }
+  return output;
+}
+
+auto make_header(std::mt19937& rng) -> header::header {
+  return header::header{ .type = header::message_type_e::method_call,
+                         .body_length = static_cast<std::uint32_t>(make_uint64(rng) % 4096),
+                         .serial = static_cast<std::uint32_t>(make_uint64(rng) % 65536) + 1,
+                         .fields = {
+                             { header::field_path{ adbus::protocol::path::make("/org/freedesktop/DBus").value() } },
+                             { header::field_destination{ "org.freedesktop.DBus" } },
+                             { header::field_interface{ "org.freedesktop.DBus.Properties" } },
+                             { header::field_member{ "GetAll" } },
+                             { header::field_signature{ std::string_view{ "s" } } },
+                         } };
+}
+
+auto make_doubles(std::mt19937& rng, std::size_t size) -> std::vector<double> {
+  std::vector<double> output(size);
+  for (auto& d : output) {
+    d = make_double(rng);
+  }
+  return output;
+}
+
+auto make_bytes(std::mt19937& rng, std::size_t size) -> std::vector<std::uint8_t> {
+  std::vector<std::uint8_t> output(size);
+  for (auto& b : output) {
+    b = static_cast<std::uint8_t>(make_uint64(rng));
+  }
+  return output;
+}
+
+void set_counters(benchmark::State& state, std::size_t message_size) {
+  state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * message_size));
+  state.counters["message_size"] = static_cast<double>(message_size);
+  state.counters["messages"] = benchmark::Counter(static_cast<double>(state.iterations()), benchmark::Counter::kIsRate);
+}
+
+template <typename value_t>
+void write_value(benchmark::State& state, value_t const& value) {
+  std::size_t message_size{};
+  for (auto _ : state) {
+    // A fresh buffer each iteration, this is what write_dbus_binary(value) does and includes the allocation cost
+    std::string buffer{};
+    auto err = adbus::protocol::write_dbus_binary(value, buffer);
+    benchmark::DoNotOptimize(err);
+    benchmark::DoNotOptimize(buffer.data());
+    message_size = buffer.size();
+  }
+  set_counters(state, message_size);
+}
+
+template <typename value_t>
+void read_value(benchmark::State& state, value_t const& input) {
+  auto const buffer{ adbus::protocol::write_dbus_binary(input).value() };
+  for (auto _ : state) {
+    value_t value{};
+    auto err = adbus::protocol::read_dbus_binary(value, buffer);
+    benchmark::DoNotOptimize(err);
+    benchmark::DoNotOptimize(value);
+  }
+  set_counters(state, buffer.size());
+}
+
+template <typename value_t>
+void bm_write(benchmark::State& state, value_t (*generate)(std::mt19937&)) {
+  std::mt19937 rng{ seed };
+  write_value(state, generate(rng));
+}
+
+template <typename value_t>
+void bm_read(benchmark::State& state, value_t (*generate)(std::mt19937&)) {
+  std::mt19937 rng{ seed };
+  read_value(state, generate(rng));
+}
+
+template <typename value_t>
+void bm_write_array(benchmark::State& state, value_t (*generate)(std::mt19937&, std::size_t)) {
+  std::mt19937 rng{ seed };
+  write_value(state, generate(rng, static_cast<std::size_t>(state.range(0))));
+}
+
+template <typename value_t>
+void bm_read_array(benchmark::State& state, value_t (*generate)(std::mt19937&, std::size_t)) {
+  std::mt19937 rng{ seed };
+  read_value(state, generate(rng, static_cast<std::size_t>(state.range(0))));
+}
+
+// The same arrays as sent by a peer of the other byte order, every element is swapped while it is copied
+template <typename value_t>
+void bm_read_array_swapped(benchmark::State& state, value_t (*generate)(std::mt19937&, std::size_t)) {
+  std::mt19937 rng{ seed };
+  auto buffer{ adbus::protocol::write_dbus_binary(generate(rng, static_cast<std::size_t>(state.range(0)))).value() };
+  std::reverse(buffer.begin(), buffer.begin() + sizeof(std::uint32_t));  // the length
+  constexpr auto other{ std::endian::native == std::endian::little ? std::endian::big : std::endian::little };
+  for (auto _ : state) {
+    value_t value{};
+    auto err = adbus::protocol::read_dbus_binary(value, buffer, other);
+    benchmark::DoNotOptimize(err);
+    benchmark::DoNotOptimize(value);
+  }
+  set_counters(state, buffer.size());
+}
+
+// A method call carrying a byte array of the given size, header and body serialized together
+void bm_write_message(benchmark::State& state) {
+  std::mt19937 rng{ seed };
+  auto const header{ make_header(rng) };
+  auto const body{ make_bytes(rng, static_cast<std::size_t>(state.range(0))) };
+  std::size_t message_size{};
+  for (auto _ : state) {
+    std::string buffer{};
+    auto err = adbus::protocol::write_dbus_message(header, body, buffer);
+    benchmark::DoNotOptimize(err);
+    benchmark::DoNotOptimize(buffer.data());
+    message_size = buffer.size();
+  }
+  set_counters(state, message_size);
+}
+
+// Same message written to a gather buffer, the byte array is referenced instead of copied
+void bm_write_message_gather(benchmark::State& state) {
+  std::mt19937 rng{ seed };
+  auto const header{ make_header(rng) };
+  auto const body{ make_bytes(rng, static_cast<std::size_t>(state.range(0))) };
+  std::size_t message_size{};
+  for (auto _ : state) {
+    adbus::protocol::gather_buffer buffer{};
+    auto err = adbus::protocol::write_dbus_message(header, body, buffer);
+    benchmark::DoNotOptimize(err);
+    auto segments = buffer.buffers();
+    benchmark::DoNotOptimize(segments.data());
+    message_size = buffer.size();
+  }
+  set_counters(state, message_size);
+}
+
+BENCHMARK_CAPTURE(bm_write, uint64, &make_uint64);
+BENCHMARK_CAPTURE(bm_read, uint64, &make_uint64);
+BENCHMARK_CAPTURE(bm_write, double, &make_double);
+BENCHMARK_CAPTURE(bm_read, double, &make_double);
+BENCHMARK_CAPTURE(bm_write, string, &make_string);
+BENCHMARK_CAPTURE(bm_read, string, &make_string);
+BENCHMARK_CAPTURE(bm_write, vector_of_foo, &make_foos);
+BENCHMARK_CAPTURE(bm_read, vector_of_foo, &make_foos);
+BENCHMARK_CAPTURE(bm_write, map, &make_map);
+BENCHMARK_CAPTURE(bm_read, map, &make_map);
+BENCHMARK_CAPTURE(bm_write, variant_properties, &make_properties);
+BENCHMARK_CAPTURE(bm_read, variant_properties, &make_properties);
+BENCHMARK_CAPTURE(bm_write, header, &make_header);
+BENCHMARK_CAPTURE(bm_read, header, &make_header);
+BENCHMARK_CAPTURE(bm_write_array, doubles, &make_doubles)->RangeMultiplier(16)->Range(16, 1 << 20);
+BENCHMARK_CAPTURE(bm_read_array, doubles, &make_doubles)->RangeMultiplier(16)->Range(16, 1 << 20);
+BENCHMARK_CAPTURE(bm_read_array_swapped, doubles, &make_doubles)->RangeMultiplier(16)->Range(16, 1 << 20);
+BENCHMARK_CAPTURE(bm_write_array, bytes, &make_bytes)->RangeMultiplier(16)->Range(16, 1 << 20);
+BENCHMARK_CAPTURE(bm_read_array, bytes, &make_bytes)->RangeMultiplier(16)->Range(16, 1 << 20);
+BENCHMARK(bm_write_message)->RangeMultiplier(16)->Range(16, 1 << 20);
+BENCHMARK(bm_write_message_gather)->RangeMultiplier(16)->Range(16, 1 << 20);
+
+BENCHMARK_MAIN();
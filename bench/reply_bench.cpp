@@ -0,0 +1,114 @@
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <system_error>
+
+#include <benchmark/benchmark.h>
+#include <boost/asio.hpp>
+
+#include <adbus/core/completion_slot.hpp>
+#include <adbus/core/serial_map.hpp>
+
+// the vendored boost::sam headers need a recent Boost, the comparison with them is opt in
+#if defined(ADBUS_BENCH_BOOST_SAM)
+#define BOOST_SAM_HEADER_ONLY
+#include <adbus/ext/boost/sam/condition_variable.hpp>
+#endif
+
+// Latency from a call registering its waiter to the reply handler running, without the socket. Every iteration
+// registers one pending call, waits for it, delivers the reply from a handler on the io_context like the read loop does
+// and polls until the waiting handler ran.
+
+namespace asio = boost::asio;
+
+namespace {
+
+constexpr std::size_t reply_size{ 64 };
+
+#if defined(ADBUS_BENCH_BOOST_SAM)
+// The previous incoming_message_queue, a shared event per call which is notified through a condition variable
+void bm_reply_condition_variable(benchmark::State& state) {
+  using condition_variable = boost::sam::basic_condition_variable<asio::any_io_executor>;
+  struct event {
+    condition_variable cv;
+    std::string message{};
+  };
+  asio::io_context ctx{ 1 };
+  std::mutex mutex{};
+  adbus::serial_map<std::shared_ptr<event>> pending{};
+  std::uint32_t serial{};
+  std::size_t received{};
+  for (auto _ : state) {
+    ++serial;
+    auto waiter{ std::make_shared<event>(condition_variable{ ctx.get_executor() }) };
+    {
+      std::scoped_lock lock{ mutex };
+      pending.insert(serial, waiter);
+    }
+    asio::async_compose<decltype(asio::detached), void(std::error_code)>(
+        [first_call = true, waiter](auto& self, std::error_code err = {}) mutable {
+          if (first_call) {
+            first_call = false;
+            return waiter->cv.async_wait(std::move(self));
+          }
+          self.complete(err);
+        },
+        [&, waiter](std::error_code) { received += waiter->message.size(); }, ctx);
+    asio::post(ctx, [&] {
+      std::scoped_lock lock{ mutex };
+      auto reply{ pending.extract(serial) };
+      (*reply)->message.assign(reply_size, 'x');
+      (*reply)->cv.notify_all();
+    });
+    ctx.poll();
+    ctx.restart();
+  }
+  benchmark::DoNotOptimize(received);
+}
+BENCHMARK(bm_reply_condition_variable);
+#endif
+
+// The completion slot embedded in the pending call, completed from the read loop outside of the lock
+void bm_reply_completion_slot(benchmark::State& state) {
+  using slot_t = adbus::completion_slot<void(std::error_code, std::string)>;
+  struct pending_call {
+    slot_t slot{};
+    std::optional<std::string> reply{};
+  };
+  asio::io_context ctx{ 1 };
+  std::mutex mutex{};
+  adbus::serial_map<pending_call> pending{};
+  std::uint32_t serial{};
+  std::size_t received{};
+  for (auto _ : state) {
+    ++serial;
+    {
+      std::scoped_lock lock{ mutex };
+      pending.insert(serial, {});
+    }
+    {
+      std::scoped_lock lock{ mutex };
+      pending.find(serial)->slot.emplace(
+          [&](std::error_code, std::string message) { received += message.size(); }, ctx.get_executor());
+    }
+    asio::post(ctx, [&] {
+      slot_t slot{};
+      {
+        std::scoped_lock lock{ mutex };
+        slot = std::move(pending.find(serial)->slot);
+        pending.erase(serial);
+      }
+      slot.complete({}, std::string(reply_size, 'x'));
+    });
+    ctx.poll();
+    ctx.restart();
+  }
+  benchmark::DoNotOptimize(received);
+}
+BENCHMARK(bm_reply_completion_slot);
+
+}  // namespace
+
+BENCHMARK_MAIN();
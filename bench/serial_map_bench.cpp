@@ -0,0 +1,73 @@
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <adbus/core/serial_map.hpp>
+
+// Pending calls as kept by incoming_message_queue, a reply removes the waiter with its serial. The benchmark keeps
+// state.range(0) calls outstanding, every iteration completes a random one of them and issues a new call in its place.
+
+namespace {
+
+constexpr std::uint32_t seed{ 1337 };
+
+struct waiter {
+  std::uint32_t serial{};
+};
+
+// The previous layout of incoming_message_queue, a linear scan and an erase from the middle
+void bm_pending_vector(benchmark::State& state) {
+  auto const outstanding{ static_cast<std::uint32_t>(state.range(0)) };
+  std::mt19937 rng{ seed };
+  std::vector<std::shared_ptr<waiter>> pending{};
+  std::uint32_t next_serial{ 1 };
+  std::vector<std::uint32_t> serials{};
+  for (; next_serial <= outstanding; ++next_serial) {
+    pending.emplace_back(std::make_shared<waiter>(next_serial));
+    serials.emplace_back(next_serial);
+  }
+  for (auto _ : state) {
+    auto& reply_serial{ serials[rng() % outstanding] };
+    auto it{ std::ranges::find_if(pending, [serial = reply_serial](auto&& w) { return w->serial == serial; }) };
+    if (it != pending.end()) {
+      benchmark::DoNotOptimize(it->get());
+      pending.erase(it);
+    }
+    reply_serial = next_serial;
+    pending.emplace_back(std::make_shared<waiter>(next_serial++));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+void bm_pending_serial_map(benchmark::State& state) {
+  auto const outstanding{ static_cast<std::uint32_t>(state.range(0)) };
+  std::mt19937 rng{ seed };
+  adbus::serial_map<std::shared_ptr<waiter>> pending{};
+  std::uint32_t next_serial{ 1 };
+  std::vector<std::uint32_t> serials{};
+  for (; next_serial <= outstanding; ++next_serial) {
+    pending.insert(next_serial, std::make_shared<waiter>(next_serial));
+    serials.emplace_back(next_serial);
+  }
+  for (auto _ : state) {
+    auto& reply_serial{ serials[rng() % outstanding] };
+    if (auto found{ pending.extract(reply_serial) }) {
+      benchmark::DoNotOptimize(found->get());
+    }
+    reply_serial = next_serial;
+    pending.insert(next_serial, std::make_shared<waiter>(next_serial));
+    ++next_serial;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+}  // namespace
+
+BENCHMARK(bm_pending_vector)->RangeMultiplier(10)->Range(10, 10'000);
+BENCHMARK(bm_pending_serial_map)->RangeMultiplier(10)->Range(10, 10'000);
+
+BENCHMARK_MAIN();
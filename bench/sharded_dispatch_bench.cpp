@@ -0,0 +1,95 @@
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <boost/asio.hpp>
+
+#include <adbus/core/buffer_pool.hpp>
+#include <adbus/core/object_server.hpp>
+#include <adbus/core/serial_counter.hpp>
+#include <adbus/core/sharded_executor.hpp>
+#include <adbus/protocol/header_view.hpp>
+#include <adbus/protocol/write.hpp>
+
+// Method calls served the way basic_dbus_socket does after dispatch_calls_on, without the socket. Every iteration copies
+// a batch of calls to objects_count objects out of the "receive buffer", posts each to the shard of its object path and
+// waits until all replies were sent. state.range(0) is the number of threads running the shards.
+
+namespace asio = boost::asio;
+namespace header = adbus::protocol::header;
+
+namespace {
+
+constexpr std::size_t objects_count{ 64 };
+constexpr std::size_t shards_count{ 64 };
+constexpr std::size_t batch_size{ 1024 };
+// work of a handler, a few microseconds
+constexpr std::uint32_t handler_rounds{ 2000 };
+
+struct call {
+  std::string bytes{};
+  std::string path{};
+};
+
+auto make_calls() -> std::vector<call> {
+  namespace protocol = adbus::protocol;
+  std::vector<call> output{};
+  for (std::size_t idx{}; idx < batch_size; ++idx) {
+    auto path{ "/org/example/Object" + std::to_string(idx % objects_count) };
+    header::header hdr{ .type = header::message_type_e::method_call,
+                        .serial = static_cast<std::uint32_t>(idx + 1),
+                        .fields = {
+                            { header::field_path{ protocol::path::make(path).value() } },
+                            { header::field_interface{ protocol::interface_name::make("org.example.Hash").value() } },
+                            { header::field_member{ protocol::member_name::make("Hash").value() } },
+                            { header::field_sender{ std::pmr::string{ ":1.7" } } },
+                            { header::field_signature{ protocol::type::signature_v<std::uint32_t> } },
+                        } };
+    output.push_back({ .bytes = protocol::write_dbus_message(hdr, static_cast<std::uint32_t>(idx)).value(),
+                       .path = std::move(path) });
+  }
+  return output;
+}
+
+auto hash(std::uint32_t value) -> std::uint32_t {
+  for (std::uint32_t round{}; round < handler_rounds; ++round) {
+    value = value * 2654435761U + round;
+  }
+  return value;
+}
+
+void bm_sharded_dispatch(benchmark::State& state) {
+  auto const threads{ static_cast<std::size_t>(state.range(0)) };
+  asio::thread_pool pool{ threads };
+  adbus::sharded_executor<asio::thread_pool::executor_type> workers{ pool.get_executor(), shards_count };
+  adbus::serial_counter serials{};
+  std::atomic<std::size_t> replies{};
+  adbus::object_server server{ serials, [&replies](adbus::buffer_pool::buffer&&) {
+                                replies.fetch_add(1, std::memory_order_release);
+                              } };
+  for (std::size_t idx{}; idx < objects_count; ++idx) {
+    server.add_method<std::uint32_t, std::uint32_t>("/org/example/Object" + std::to_string(idx), "org.example.Hash",
+                                                    "Hash", [](std::uint32_t value) { return hash(value); });
+  }
+  auto const calls{ make_calls() };
+
+  for (auto _ : state) {
+    replies.store(0, std::memory_order_relaxed);
+    for (auto const& received : calls) {
+      workers.post(received.path, [&server, bytes = received.bytes]() {
+        server.dispatch(header::header_view::make(bytes).value());
+      });
+    }
+    while (replies.load(std::memory_order_acquire) != calls.size()) {
+    }
+  }
+  pool.join();
+  state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * calls.size()));
+}
+BENCHMARK(bm_sharded_dispatch)->RangeMultiplier(2)->Range(1, 16)->UseRealTime();
+
+}  // namespace
+
+BENCHMARK_MAIN();
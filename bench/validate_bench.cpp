@@ -0,0 +1,111 @@
+#include <cstdint>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <adbus/protocol/name.hpp>
+#include <adbus/protocol/path.hpp>
+
+// Validation of object paths and names as done for every received header field. The scalar variants are the previous
+// character at a time loops, state.range(0) is the length of the validated strings.
+
+namespace {
+
+constexpr std::uint32_t seed{ 1337 };
+namespace protocol = adbus::protocol;
+
+// Elements of 1 to 12 word characters joined by separator, starting with a letter
+auto make_inputs(std::size_t length, char separator, bool leading_separator) -> std::vector<std::string> {
+  static constexpr std::string_view letters{ "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_" };
+  static constexpr std::string_view word{ "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_0123456789" };
+  std::mt19937 rng{ seed };
+  std::uniform_int_distribution<std::size_t> element_length{ 1, 12 };
+  std::vector<std::string> output(64);
+  for (auto& input : output) {
+    if (leading_separator) {
+      input += separator;
+    }
+    input += letters[rng() % letters.size()];
+    while (input.size() < length) {
+      for (auto count{ element_length(rng) }; count > 0 && input.size() < length; --count) {
+        input += word[rng() % word.size()];
+      }
+      if (input.size() + 1 < length) {
+        input += separator;
+        input += letters[rng() % letters.size()];
+      }
+    }
+  }
+  return output;
+}
+
+constexpr auto is_word_char(char c) noexcept -> bool {
+  return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+auto validate_path_scalar(std::string_view input) noexcept -> std::size_t {
+  for (std::size_t idx{ 1 }; idx < input.size(); ++idx) {
+    if (input[idx] == '/' && input[idx - 1] == '/') {
+      return idx;
+    }
+    if (!is_word_char(input[idx]) && input[idx] != '/') {
+      return idx;
+    }
+  }
+  return std::string_view::npos;
+}
+
+auto validate_name_scalar(std::string_view input) noexcept -> std::size_t {
+  for (std::size_t idx{ 1 }; idx < input.size(); ++idx) {
+    if (!is_word_char(input[idx]) && input[idx] != '.') {
+      return idx;
+    }
+  }
+  for (std::size_t idx{ 1 }; idx < input.size(); ++idx) {
+    if (input[idx] == '.' && input[idx - 1] == '.') {
+      return idx;
+    }
+  }
+  return std::string_view::npos;
+}
+
+template <auto validate>
+void run(benchmark::State& state, std::vector<std::string> const& inputs) {
+  std::size_t bytes{};
+  for (auto _ : state) {
+    for (auto const& input : inputs) {
+      benchmark::DoNotOptimize(validate(input));
+      bytes += input.size();
+    }
+  }
+  state.SetBytesProcessed(static_cast<std::int64_t>(bytes));
+  state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(inputs.size()));
+}
+
+void bm_path_scalar(benchmark::State& state) {
+  run<validate_path_scalar>(state, make_inputs(static_cast<std::size_t>(state.range(0)), '/', true));
+}
+
+void bm_path(benchmark::State& state) {
+  run<protocol::path::validate>(state, make_inputs(static_cast<std::size_t>(state.range(0)), '/', true));
+}
+
+void bm_interface_name_scalar(benchmark::State& state) {
+  run<validate_name_scalar>(state, make_inputs(static_cast<std::size_t>(state.range(0)), '.', false));
+}
+
+void bm_interface_name(benchmark::State& state) {
+  run<protocol::interface_name::validate>(state, make_inputs(static_cast<std::size_t>(state.range(0)), '.', false));
+}
+
+}  // namespace
+
+BENCHMARK(bm_path_scalar)->RangeMultiplier(4)->Range(8, 255);
+BENCHMARK(bm_path)->RangeMultiplier(4)->Range(8, 255);
+BENCHMARK(bm_interface_name_scalar)->RangeMultiplier(4)->Range(8, 255);
+BENCHMARK(bm_interface_name)->RangeMultiplier(4)->Range(8, 255);
+
+BENCHMARK_MAIN();
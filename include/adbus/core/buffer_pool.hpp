@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace adbus {
+
+/// \brief Free list of message buffers, a buffer keeps its capacity when returned so serializing a message into a
+/// reused buffer does not allocate
+/// \note The pool must outlive every buffer acquired from it
+class buffer_pool {
+public:
+  static constexpr std::size_t default_max_pooled{ 64 };
+
+  /// \brief A buffer on loan from the pool, returned to it on destruction
+  class buffer {
+  public:
+    buffer() = default;
+    buffer(buffer&& other) noexcept
+        : pool_{ std::exchange(other.pool_, nullptr) }, value_{ std::move(other.value_) } {}
+    auto operator=(buffer&& other) noexcept -> buffer& {
+      if (this != &other) {
+        release();
+        pool_ = std::exchange(other.pool_, nullptr);
+        value_ = std::move(other.value_);
+      }
+      return *this;
+    }
+    buffer(buffer const&) = delete;
+    auto operator=(buffer const&) -> buffer& = delete;
+    ~buffer() { release(); }
+
+    [[nodiscard]] auto operator*() noexcept -> std::string& { return value_; }
+    [[nodiscard]] auto operator*() const noexcept -> std::string const& { return value_; }
+    [[nodiscard]] auto operator->() noexcept -> std::string* { return &value_; }
+    [[nodiscard]] auto operator->() const noexcept -> std::string const* { return &value_; }
+    [[nodiscard]] auto view() const noexcept -> std::string_view { return value_; }
+
+  private:
+    friend buffer_pool;
+    buffer(buffer_pool* pool, std::string&& value) noexcept : pool_{ pool }, value_{ std::move(value) } {}
+
+    void release() noexcept {
+      if (pool_ != nullptr) {
+        std::exchange(pool_, nullptr)->release(std::move(value_));
+      }
+    }
+
+    buffer_pool* pool_{};
+    std::string value_{};
+  };
+
+  buffer_pool() = default;
+  explicit buffer_pool(std::size_t max_pooled) : max_pooled_{ max_pooled } {}
+  buffer_pool(buffer_pool const&) = delete;
+  auto operator=(buffer_pool const&) -> buffer_pool& = delete;
+
+  /// \brief An empty buffer, with the capacity of an earlier message when one was returned
+  [[nodiscard]] auto acquire() -> buffer {
+    std::scoped_lock lock{ mutex_ };
+    if (free_.empty()) {
+      return { this, std::string{} };
+    }
+    std::string value{ std::move(free_.back()) };
+    free_.pop_back();
+    return { this, std::move(value) };
+  }
+
+  /// \brief Number of buffers waiting to be reused
+  [[nodiscard]] auto size() const -> std::size_t {
+    std::scoped_lock lock{ mutex_ };
+    return free_.size();
+  }
+
+private:
+  void release(std::string&& value) noexcept {
+    value.clear();
+    std::scoped_lock lock{ mutex_ };
+    // beyond max_pooled the buffer is freed, e.g. after a burst of replies
+    if (free_.size() < max_pooled_) {
+      try {
+        free_.emplace_back(std::move(value));
+      } catch (...) {
+        // dropping the buffer is fine
+      }
+    }
+  }
+
+  mutable std::mutex mutex_{};
+  std::vector<std::string> free_{};
+  std::size_t max_pooled_{ default_max_pooled };
+};
+
+}  // namespace adbus
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include <boost/asio/associated_allocator.hpp>
+#include <boost/asio/associated_executor.hpp>
+#include <boost/asio/dispatch.hpp>
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/post.hpp>
+
+namespace adbus {
+
+template <typename signature_t>
+class completion_slot;
+
+/// \brief Holds at most one type erased completion handler until it is completed once
+/// \note The handler is stored in memory from its associated allocator, which is released before the handler is
+/// invoked, so a handler which stores the next handler in the same slot reuses it. The slot itself is one pointer and
+/// is meant to be embedded where the pending operation is kept, e.g. in a serial_map entry. It is not synchronized,
+/// emplace and complete are expected to be called under the same lock as the lookup of the slot.
+template <typename... args_t>
+class completion_slot<void(args_t...)> {
+public:
+  completion_slot() noexcept = default;
+  completion_slot(completion_slot&& other) noexcept : op_{ std::exchange(other.op_, nullptr) } {}
+  auto operator=(completion_slot&& other) noexcept -> completion_slot& {
+    if (this != &other) {
+      reset();
+      op_ = std::exchange(other.op_, nullptr);
+    }
+    return *this;
+  }
+  completion_slot(completion_slot const&) = delete;
+  auto operator=(completion_slot const&) -> completion_slot& = delete;
+  ~completion_slot() { reset(); }
+
+  [[nodiscard]] auto has_handler() const noexcept -> bool { return op_ != nullptr; }
+
+  /// \brief Stores handler, it is completed on its associated executor or fallback_executor when it has none
+  template <typename handler_t, typename executor_t>
+  void emplace(handler_t&& handler, executor_t const& fallback_executor) {
+    auto executor{ boost::asio::get_associated_executor(handler, fallback_executor) };
+    auto allocator{ boost::asio::get_associated_allocator(handler) };
+    emplace(std::forward<handler_t>(handler), std::move(executor), std::move(allocator));
+  }
+
+  /// \brief Stores handler, executor and allocator stand in for the associated ones, for handlers wrapping another one
+  template <typename handler_t, typename executor_t, typename allocator_t>
+  void emplace(handler_t&& handler, executor_t executor, allocator_t const& allocator) {
+    using op_t = op<std::decay_t<handler_t>, executor_t, allocator_t>;
+    using op_allocator_t = typename std::allocator_traits<allocator_t>::template rebind_alloc<op_t>;
+    reset();
+    op_allocator_t op_allocator{ allocator };
+    auto* memory{ std::allocator_traits<op_allocator_t>::allocate(op_allocator, 1) };
+    try {
+      op_ = std::construct_at(memory, std::forward<handler_t>(handler), std::move(executor), allocator);
+    } catch (...) {
+      std::allocator_traits<op_allocator_t>::deallocate(op_allocator, memory, 1);
+      throw;
+    }
+  }
+
+  /// \brief Completes the handler with args, inline when the caller already runs on the executor of the handler
+  /// \pre has_handler()
+  void complete(args_t... args) { std::exchange(op_, nullptr)->complete(false, std::move(args)...); }
+
+  /// \brief Completes the handler with args, never inline, for when the handler may be completed from its initiation
+  /// \pre has_handler()
+  void post(args_t... args) { std::exchange(op_, nullptr)->complete(true, std::move(args)...); }
+
+  /// \brief Drops the handler without invoking it
+  void reset() noexcept {
+    if (op_ != nullptr) {
+      std::exchange(op_, nullptr)->destroy();
+    }
+  }
+
+private:
+  // Base of the type erased operation, function pointers instead of virtual functions keep it a single allocation
+  struct op_base {
+    using complete_fn = void (*)(op_base*, bool, args_t&&...);
+    using destroy_fn = void (*)(op_base*) noexcept;
+
+    void complete(bool post, args_t&&... args) { complete_(this, post, std::move(args)...); }
+    void destroy() noexcept { destroy_(this); }
+
+    complete_fn complete_;
+    destroy_fn destroy_;
+  };
+
+  template <typename handler_t, typename executor_t, typename allocator_t>
+  struct op : op_base {
+    using op_allocator_t = typename std::allocator_traits<allocator_t>::template rebind_alloc<op>;
+
+    // The handler together with the arguments, keeps the associated allocator for the executor to use
+    struct invoker {
+      using allocator_type = allocator_t;
+
+      handler_t handler;
+      std::tuple<args_t...> args;
+      allocator_t allocator;
+
+      [[nodiscard]] auto get_allocator() const noexcept -> allocator_type { return allocator; }
+      void operator()() { std::apply(std::move(handler), std::move(args)); }
+    };
+
+    template <typename handler_in_t>
+    op(handler_in_t&& handler_in, executor_t executor, allocator_t const& allocator_in)
+        : op_base{ &do_complete, &do_destroy }, handler{ std::forward<handler_in_t>(handler_in) },
+          work{ std::move(executor) }, allocator{ allocator_in } {}
+
+    static void do_complete(op_base* base, bool post, args_t&&... args) {
+      auto* self{ static_cast<op*>(base) };
+      invoker function{ std::move(self->handler), { std::move(args)... }, self->allocator };
+      // the work guard keeps the executor from running out of work until the handler is scheduled
+      auto work_mv{ std::move(self->work) };
+      deallocate(self);
+      if (post) {
+        boost::asio::post(work_mv.get_executor(), std::move(function));
+      } else {
+        boost::asio::dispatch(work_mv.get_executor(), std::move(function));
+      }
+    }
+
+    static void do_destroy(op_base* base) noexcept { deallocate(static_cast<op*>(base)); }
+
+    static void deallocate(op* self) noexcept {
+      op_allocator_t op_allocator{ self->allocator };
+      std::destroy_at(self);
+      std::allocator_traits<op_allocator_t>::deallocate(op_allocator, self, 1);
+    }
+
+    handler_t handler;
+    boost::asio::executor_work_guard<executor_t> work;
+    allocator_t allocator;
+  };
+
+  op_base* op_{};
+};
+
+}  // namespace adbus
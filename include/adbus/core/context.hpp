@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include <memory_resource>
 
 #include <glaze/core/common.hpp>
 
@@ -23,10 +24,15 @@ enum struct error_code : std::uint8_t {
   string_too_long,
   array_too_long,
   invalid_enum_conversion, // to string
+  message_too_long, // header and body exceed the maximum message length of the specification
   // read errors
   out_of_range, // if buffer is smaller than the expected input is
   unexpected_enum, // from string
   unexpected_variant, // Any of the given variant type types do not match the signature from buffer
+  unaligned, // a zero copy view was requested into a buffer which is not aligned for the element type
+  invalid_signature, // a signature read at run time is not a sequence of complete types
+  nesting_too_deep, // containers nested deeper than the specification allows
+  foreign_byte_order, // a zero copy view was requested into a message of the other byte order
   // remember to add to glaze enumerate below
 };
 
@@ -42,6 +48,10 @@ struct error final {
 
 struct context final {
   error err{};
+  // Allocations of allocator aware values while reading, e.g. std::pmr::string and std::pmr::vector elements
+  std::pmr::memory_resource* resource{ std::pmr::get_default_resource() };
+  // The values read are in the other byte order than the host, set by the endian flag of a message header
+  bool byte_swap{ false };
 };
 
 template <class T>
@@ -71,9 +81,14 @@ struct glz::meta<adbus::protocol::error_code> {
   "string_too_long", string_too_long,
   "array_too_long", array_too_long,
   "invalid_enum_conversion", invalid_enum_conversion,
+  "message_too_long", message_too_long,
   "out_of_range", out_of_range,
   "unexpected_enum", unexpected_enum,
-  "unexpected_variant", unexpected_variant
+  "unexpected_variant", unexpected_variant,
+  "unaligned", unaligned,
+  "invalid_signature", invalid_signature,
+  "nesting_too_deep", nesting_too_deep,
+  "foreign_byte_order", foreign_byte_order
   ) };
 };
 
@@ -0,0 +1,379 @@
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <fmt/format.h>
+#include <glaze/core/common.hpp>
+
+#include <adbus/core/buffer_pool.hpp>
+#include <adbus/core/serial_counter.hpp>
+#include <adbus/protocol/header_view.hpp>
+#include <adbus/protocol/message_header.hpp>
+#include <adbus/protocol/read.hpp>
+#include <adbus/protocol/signature.hpp>
+#include <adbus/protocol/write.hpp>
+
+namespace adbus {
+
+/// \brief Error reply of a method, name is a D-Bus error name and message is sent as its only argument
+struct method_error {
+  std::string name{};
+  std::string message{};
+};
+
+namespace errors {
+inline constexpr std::string_view failed{ "org.freedesktop.DBus.Error.Failed" };
+inline constexpr std::string_view unknown_method{ "org.freedesktop.DBus.Error.UnknownMethod" };
+inline constexpr std::string_view invalid_args{ "org.freedesktop.DBus.Error.InvalidArgs" };
+}  // namespace errors
+
+/// \brief Registry of the methods served by a connection, keyed by object path, interface and member
+/// \note A method call is dispatched with a single hash lookup, its body is decoded straight into the parameters of the
+/// handler and the reply is serialized into a pooled buffer which is handed to send. Handlers are type checked when they
+/// are added, params_t and result_t must have a D-Bus signature and a call is only dispatched when its signature is the
+/// one of params_t. Adding and removing methods may happen from any thread, also from within a handler. Handlers run
+/// without the registry locked, a handler removed while it runs finishes the calls already dispatched to it.
+class object_server {
+public:
+  using send_function = std::move_only_function<void(buffer_pool::buffer&&)>;
+
+  /// \brief Reply to one call, sends at most one reply
+  /// \note Handlers which take a responder reply whenever they are done, it keeps no reference into the call
+  class responder {
+  public:
+    responder(responder&& other) noexcept
+        : server_{ std::exchange(other.server_, nullptr) }, call_serial_{ other.call_serial_ },
+          destination_{ std::move(other.destination_) }, no_reply_{ other.no_reply_ } {}
+    auto operator=(responder&& other) noexcept -> responder& {
+      server_ = std::exchange(other.server_, nullptr);
+      call_serial_ = other.call_serial_;
+      destination_ = std::move(other.destination_);
+      no_reply_ = other.no_reply_;
+      return *this;
+    }
+    responder(responder const&) = delete;
+    auto operator=(responder const&) -> responder& = delete;
+    ~responder() = default;
+
+    /// \brief False when the caller set no_reply_expected, replying is then a no-op
+    [[nodiscard]] auto expects_reply() const noexcept -> bool { return server_ != nullptr && !no_reply_; }
+
+    template <typename result_t>
+    void reply(result_t const& result) {
+      if (auto* server{ take() }) {
+        server->send_return(*this, result);
+      }
+    }
+
+    /// \brief Reply without a body
+    void reply() {
+      if (auto* server{ take() }) {
+        server->send_return(*this, glz::skip{});
+      }
+    }
+
+    void reply_error(method_error const& err) {
+      if (auto* server{ take() }) {
+        server->send_error(*this, err);
+      }
+    }
+
+  private:
+    friend object_server;
+
+    responder(object_server* server, protocol::header::header_view const& call)
+        : server_{ server }, call_serial_{ call.serial() }, destination_{ call.sender().value_or("") },
+          no_reply_{ call.flags().no_reply_expected } {}
+
+    // the server to reply through, once
+    [[nodiscard]] auto take() noexcept -> object_server* {
+      auto* server{ std::exchange(server_, nullptr) };
+      return no_reply_ ? nullptr : server;
+    }
+
+    object_server* server_{};
+    std::uint32_t call_serial_{};
+    std::string destination_{};
+    bool no_reply_{};
+  };
+
+  /// \param serials serials of the connection, the replies take theirs from it
+  /// \param send writes a serialized reply to the connection
+  object_server(serial_counter& serials, send_function send) : serials_{ &serials }, send_{ std::move(send) } {}
+  object_server(object_server const&) = delete;
+  auto operator=(object_server const&) -> object_server& = delete;
+
+  /// \brief Serves member of interface at path, params_t or result_t may be void for an empty body
+  /// \param fn one of
+  ///   result_t(params_t const&), returns the reply,
+  ///   std::expected<result_t, method_error>(params_t const&), returns the reply or an error reply,
+  ///   void(params_t const&, responder), replies later through the responder,
+  /// without the params_t argument when params_t is void
+  /// \return false when the method is already served
+  template <typename params_t, typename result_t>
+  auto add_method(std::string_view path, std::string_view interface, std::string_view member, auto&& fn) -> bool {
+    static_assert(std::is_void_v<params_t> || protocol::type::has_signature<params_t>,
+                  "params_t must have a D-Bus signature");
+    static_assert(std::is_void_v<result_t> || protocol::type::has_signature<result_t>,
+                  "result_t must have a D-Bus signature");
+    using fn_t = std::decay_t<decltype(fn)>;
+    static_assert(handler_form<fn_t, params_t, result_t>() != form::invalid,
+                  "fn must be invocable as result_t(params_t const&), std::expected<result_t, method_error>(params_t "
+                  "const&) or void(params_t const&, responder)");
+    auto invoker{ std::make_shared<invoker_t>(make_invoker<params_t, result_t>(fn_t{ std::forward<decltype(fn)>(fn) })) };
+    std::unique_lock lock{ mutex_ };
+    auto [added, inserted]{ methods_.try_emplace(
+        method_key{ std::string{ path }, std::string{ interface }, std::string{ member } }, invoker) };
+    if (!inserted) {
+      return false;
+    }
+    // a call may omit the interface, it then goes to the first method of that name added at the path
+    members_[method_key{ std::string{ path }, {}, std::string{ member } }].emplace_back(std::string{ interface },
+                                                                                         std::move(invoker));
+    return true;
+  }
+
+  auto remove_method(std::string_view path, std::string_view interface, std::string_view member) -> bool {
+    std::unique_lock lock{ mutex_ };
+    auto found{ methods_.find(method_view{ path, interface, member }) };
+    if (found == methods_.end()) {
+      return false;
+    }
+    if (auto by_member{ members_.find(method_view{ path, {}, member }) }; by_member != members_.end()) {
+      std::erase_if(by_member->second, [interface](auto const& entry) { return entry.first == interface; });
+      if (by_member->second.empty()) {
+        members_.erase(by_member);
+      }
+    }
+    methods_.erase(found);
+    return true;
+  }
+
+  [[nodiscard]] auto size() const -> std::size_t {
+    std::shared_lock lock{ mutex_ };
+    return methods_.size();
+  }
+
+  /// \brief Calls the method call is addressed to, or replies with an UnknownMethod error
+  /// \return false when no method was found
+  /// \note The handler runs before dispatch returns, call only needs to stay valid until then
+  auto dispatch(protocol::header::header_view const& call) -> bool {
+    using std::string_view_literals::operator""sv;
+    responder to{ this, call };
+    auto const path{ call.path().value_or(""sv) };
+    auto const interface{ call.interface().value_or(""sv) };
+    auto const member{ call.member().value_or(""sv) };
+    // the handler is shared out of the registry, it runs after the lock is released
+    std::shared_ptr<invoker_t> found{};
+    {
+      std::shared_lock lock{ mutex_ };
+      if (interface.empty()) {
+        auto by_member{ members_.find(method_view{ path, {}, member }) };
+        if (by_member != members_.end()) {
+          found = by_member->second.front().second;
+        }
+      } else if (auto method{ methods_.find(method_view{ path, interface, member }) }; method != methods_.end()) {
+        found = method->second;
+      }
+    }
+    if (found == nullptr) {
+      to.reply_error({ .name = std::string{ errors::unknown_method },
+                       .message = fmt::format("No such method '{}' in interface '{}' at object path '{}'", member,
+                                              interface, path) });
+      return false;
+    }
+    (*found)(call, std::move(to));
+    return true;
+  }
+
+private:
+  using invoker_t = std::move_only_function<void(protocol::header::header_view const&, responder&&)>;
+
+  enum struct form : std::uint8_t { invalid, value, expected, deferred };
+
+  // How fn_t is called and replies, with or without a params_t argument
+  template <typename fn_t, typename params_t, typename result_t>
+  static consteval auto handler_form() -> form {
+    auto classify{ []<typename... args_t>(std::type_identity<std::tuple<args_t...>>) {
+      if constexpr (std::invocable<fn_t&, args_t..., responder>) {
+        return form::deferred;
+      } else if constexpr (std::invocable<fn_t&, args_t...>) {
+        using return_t = std::invoke_result_t<fn_t&, args_t...>;
+        if constexpr (std::same_as<return_t, std::expected<result_t, method_error>>) {
+          return form::expected;
+        } else if constexpr (std::is_void_v<result_t>) {
+          return std::is_void_v<return_t> ? form::value : form::invalid;
+        } else if constexpr (std::convertible_to<return_t, result_t const&>) {
+          return form::value;
+        } else {
+          return form::invalid;
+        }
+      } else {
+        return form::invalid;
+      }
+    } };
+    if constexpr (std::is_void_v<params_t>) {
+      return classify(std::type_identity<std::tuple<>>{});
+    } else {
+      return classify(std::type_identity<std::tuple<params_t const&>>{});
+    }
+  }
+
+  // Checks the signature of the call, decodes its body and calls fn with it
+  template <typename params_t, typename result_t, typename fn_t>
+  static auto make_invoker(fn_t fn) -> invoker_t {
+    return [fn_mv = std::move(fn)](protocol::header::header_view const& call, responder&& to) mutable {
+      constexpr auto expected_signature{ [] {
+        if constexpr (std::is_void_v<params_t>) {
+          return std::string_view{};
+        } else {
+          return std::string_view{ protocol::type::signature_v<params_t> };
+        }
+      }() };
+      auto const signature{ call.signature().value_or(std::string_view{}) };
+      if (signature != expected_signature) {
+        return to.reply_error({ .name = std::string{ errors::invalid_args },
+                                .message = fmt::format("Expected signature '{}' got '{}'", expected_signature,
+                                                       signature) });
+      }
+      if constexpr (std::is_void_v<params_t>) {
+        invoke<params_t, result_t>(fn_mv, std::move(to));
+      } else {
+        params_t params{};
+        if (auto err{ protocol::read_dbus_binary(params, call.body(), call.byte_order()) }) {
+          return to.reply_error(
+              { .name = std::string{ errors::invalid_args }, .message = fmt::format("Invalid arguments: {}", err) });
+        }
+        invoke<params_t, result_t>(fn_mv, std::move(to), params);
+      }
+    };
+  }
+
+  template <typename params_t, typename result_t>
+  static void invoke(auto& fn, responder&& to, auto const&... params) {
+    constexpr auto kind{ handler_form<std::decay_t<decltype(fn)>, params_t, result_t>() };
+    if constexpr (kind == form::deferred) {
+      fn(params..., std::move(to));
+    } else if constexpr (kind == form::expected) {
+      auto result{ fn(params...) };
+      if (!result) {
+        return to.reply_error(result.error());
+      }
+      if constexpr (std::is_void_v<result_t>) {
+        to.reply();
+      } else {
+        to.reply(*result);
+      }
+    } else if constexpr (std::is_void_v<result_t>) {
+      fn(params...);
+      to.reply();
+    } else {
+      to.reply(static_cast<result_t const&>(fn(params...)));
+    }
+  }
+
+  [[nodiscard]] static auto reply_header(protocol::header::message_type_e type,
+                                         std::uint32_t serial,
+                                         responder const& to) -> protocol::header::header {
+    using namespace protocol::header;
+    header reply{ .type = type, .serial = serial };
+    reply.fields.emplace_back(field_reply_serial{ to.call_serial_ });
+    if (!to.destination_.empty()) {
+      reply.fields.emplace_back(field_destination{ protocol::bus_name{ { std::pmr::string{ to.destination_ } } } });
+    }
+    return reply;
+  }
+
+  template <typename result_t>
+  void send_return(responder const& to, result_t const& result) {
+    auto reply{ reply_header(protocol::header::message_type_e::method_return, serials_->next(), to) };
+    if constexpr (!std::same_as<result_t, glz::skip>) {
+      reply.fields.emplace_back(protocol::header::field_signature{ protocol::type::signature_v<result_t> });
+    }
+    auto buffer{ buffers_.acquire() };
+    if (auto err{ protocol::write_dbus_message(reply, result, *buffer) }) [[unlikely]] {
+      return send_error(to, { .name = std::string{ errors::failed },
+                              .message = fmt::format("Failed to serialize the reply: {}", err) });
+    }
+    send_(std::move(buffer));
+  }
+
+  void send_error(responder const& to, method_error const& err) {
+    auto reply{ reply_header(protocol::header::message_type_e::error, serials_->next(), to) };
+    reply.fields.emplace_back(protocol::header::field_error_name{
+        protocol::error_name{ protocol::interface_name{ { std::pmr::string{ err.name } } } } });
+    reply.fields.emplace_back(protocol::header::field_signature{ protocol::type::signature_v<std::string> });
+    auto buffer{ buffers_.acquire() };
+    if (protocol::write_dbus_message(reply, err.message, *buffer)) [[unlikely]] {
+      return;
+    }
+    send_(std::move(buffer));
+  }
+
+  struct method_key {
+    std::string path{};
+    std::string interface{};
+    std::string member{};
+  };
+
+  struct method_view {
+    std::string_view path{};
+    std::string_view interface{};
+    std::string_view member{};
+  };
+
+  struct key_hash {
+    using is_transparent = void;
+    [[nodiscard]] auto operator()(method_view const& key) const noexcept -> std::size_t {
+      std::hash<std::string_view> const hash{};
+      auto value{ hash(key.path) };
+      // boost::hash_combine
+      value ^= hash(key.interface) + 0x9e3779b9 + (value << 6) + (value >> 2);
+      value ^= hash(key.member) + 0x9e3779b9 + (value << 6) + (value >> 2);
+      return value;
+    }
+    [[nodiscard]] auto operator()(method_key const& key) const noexcept -> std::size_t {
+      return (*this)(method_view{ key.path, key.interface, key.member });
+    }
+  };
+
+  struct key_equal {
+    using is_transparent = void;
+    [[nodiscard]] static auto view(method_key const& key) noexcept -> method_view {
+      return { key.path, key.interface, key.member };
+    }
+    [[nodiscard]] static auto view(method_view const& key) noexcept -> method_view { return key; }
+    [[nodiscard]] auto operator()(auto const& lhs, auto const& rhs) const noexcept -> bool {
+      auto const left{ view(lhs) };
+      auto const right{ view(rhs) };
+      return left.path == right.path && left.interface == right.interface && left.member == right.member;
+    }
+  };
+
+  serial_counter* serials_;
+  send_function send_;
+  buffer_pool buffers_{};
+  mutable std::shared_mutex mutex_{};
+  std::unordered_map<method_key, std::shared_ptr<invoker_t>, key_hash, key_equal> methods_{};
+  // methods by path and member only, for calls without an interface, with every interface serving them in the order
+  // they were added
+  std::unordered_map<method_key, std::vector<std::pair<std::string, std::shared_ptr<invoker_t>>>, key_hash, key_equal>
+      members_{};
+};
+
+}  // namespace adbus
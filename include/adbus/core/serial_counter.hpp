@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <limits>
+
+namespace adbus {
+
+/// \brief Serials first, first + 1, ..., first + count - 1 handed out together, none of them is zero
+struct serial_block {
+  std::uint32_t first{};
+  std::uint32_t count{};
+
+  [[nodiscard]] constexpr auto size() const noexcept -> std::uint32_t { return count; }
+  [[nodiscard]] constexpr auto empty() const noexcept -> bool { return count == 0; }
+  [[nodiscard]] constexpr auto operator[](std::uint32_t idx) const noexcept -> std::uint32_t { return first + idx; }
+  [[nodiscard]] constexpr auto contains(std::uint32_t serial) const noexcept -> bool {
+    return serial - first < count;
+  }
+};
+
+/// \brief Lock free source of message serials for one connection
+/// \note The serial of a message must not be zero, when the counter would wrap around it continues at one
+class serial_counter {
+public:
+  serial_counter() = default;
+  /// \param last the serial handed out before the first call to next or reserve
+  explicit serial_counter(std::uint32_t last) noexcept : last_{ last } {}
+
+  [[nodiscard]] auto next() noexcept -> std::uint32_t { return reserve(1).first; }
+
+  /// \brief Reserves count consecutive serials in one atomic operation, e.g. for a batch of pipelined calls
+  [[nodiscard]] auto reserve(std::uint32_t count) noexcept -> serial_block {
+    if (count == 0) [[unlikely]] {
+      return {};
+    }
+    auto current{ last_.load(std::memory_order_relaxed) };
+    serial_block block{};
+    do {
+      block = { .first = current + 1, .count = count };
+      // a block never contains zero, when it would pass zero it starts over at one instead
+      if (block.first == 0 || std::numeric_limits<std::uint32_t>::max() - current < count) [[unlikely]] {
+        block.first = 1;
+      }
+    } while (!last_.compare_exchange_weak(current, block.first + count - 1, std::memory_order_relaxed));
+    return block;
+  }
+
+private:
+  std::atomic<std::uint32_t> last_{};
+};
+
+}  // namespace adbus
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace adbus {
+
+/// \brief Open addressing map from message serial to T, used to find the pending call a reply belongs to.
+/// \note Serials are never zero so zero marks an empty slot. Serials are handed out in increasing order, indexing by
+/// the low bits of the serial therefore spreads outstanding calls over consecutive slots like a ring and collisions only
+/// happen once the oldest outstanding call is a whole capacity behind. Erasing shifts the following entries back instead
+/// of leaving tombstones, so lookups stay short no matter how many calls came and went.
+template <typename T>
+class serial_map {
+public:
+  using key_type = std::uint32_t;
+  using mapped_type = T;
+
+  serial_map() = default;
+  explicit serial_map(std::size_t capacity) { rehash(capacity); }
+
+  [[nodiscard]] auto size() const noexcept -> std::size_t { return size_; }
+  [[nodiscard]] auto empty() const noexcept -> bool { return size_ == 0; }
+  [[nodiscard]] auto capacity() const noexcept -> std::size_t { return slots_.size(); }
+
+  /// \brief Inserts value for serial, returns nullptr if serial is zero or already present
+  auto insert(key_type serial, T value) -> T* {
+    if (serial == 0) [[unlikely]] {
+      return nullptr;
+    }
+    // keep the load factor at or below one half
+    if ((size_ + 1) * 2 > slots_.size()) {
+      rehash((std::max)(slots_.size() * 2, min_capacity));
+    }
+    for (auto idx{ index_of(serial) };; idx = next(idx)) {
+      auto& slot{ slots_[idx] };
+      if (slot.serial == serial) {
+        return nullptr;
+      }
+      if (slot.serial == 0) {
+        slot.serial = serial;
+        slot.value.emplace(std::move(value));
+        ++size_;
+        return &*slot.value;
+      }
+    }
+  }
+
+  [[nodiscard]] auto find(key_type serial) noexcept -> T* {
+    if (auto idx{ find_index(serial) }) {
+      return &*slots_[*idx].value;
+    }
+    return nullptr;
+  }
+
+  [[nodiscard]] auto contains(key_type serial) const noexcept -> bool { return find_index(serial).has_value(); }
+
+  /// \brief Removes the entry of serial and returns its value
+  auto extract(key_type serial) -> std::optional<T> {
+    auto idx{ find_index(serial) };
+    if (!idx) {
+      return std::nullopt;
+    }
+    std::optional<T> output{ std::move(slots_[*idx].value) };
+    erase_at(*idx);
+    return output;
+  }
+
+  auto erase(key_type serial) -> bool {
+    auto idx{ find_index(serial) };
+    if (!idx) {
+      return false;
+    }
+    erase_at(*idx);
+    return true;
+  }
+
+  void clear() noexcept {
+    for (auto& slot : slots_) {
+      slot = {};
+    }
+    size_ = 0;
+  }
+
+  /// \brief Calls fn(serial, value) for every entry, in no particular order
+  void for_each(auto&& fn) {
+    for (auto& slot : slots_) {
+      if (slot.serial != 0) {
+        fn(slot.serial, *slot.value);
+      }
+    }
+  }
+
+private:
+  static constexpr std::size_t min_capacity{ 16 };
+
+  struct slot {
+    key_type serial{};
+    std::optional<T> value{};
+  };
+
+  [[nodiscard]] auto index_of(key_type serial) const noexcept -> std::size_t { return serial & (slots_.size() - 1); }
+  [[nodiscard]] auto next(std::size_t idx) const noexcept -> std::size_t { return (idx + 1) & (slots_.size() - 1); }
+
+  [[nodiscard]] auto find_index(key_type serial) const noexcept -> std::optional<std::size_t> {
+    if (serial == 0 || slots_.empty()) {
+      return std::nullopt;
+    }
+    for (auto idx{ index_of(serial) };; idx = next(idx)) {
+      if (slots_[idx].serial == serial) {
+        return idx;
+      }
+      if (slots_[idx].serial == 0) {
+        return std::nullopt;
+      }
+    }
+  }
+
+  // Backward shift deletion, moves every following entry of the probe sequence which may sit at the freed slot
+  void erase_at(std::size_t hole) {
+    for (auto idx{ next(hole) }; slots_[idx].serial != 0; idx = next(idx)) {
+      const auto home{ index_of(slots_[idx].serial) };
+      // distance from home to idx and from home to the hole, both along the probe direction
+      const auto mask{ slots_.size() - 1 };
+      if (((idx - home) & mask) >= ((hole - home) & mask)) {
+        slots_[hole] = std::move(slots_[idx]);
+        hole = idx;
+      }
+    }
+    slots_[hole] = {};
+    --size_;
+  }
+
+  void rehash(std::size_t capacity) {
+    capacity = std::bit_ceil((std::max)(capacity, min_capacity));
+    std::vector<slot> previous{ std::exchange(slots_, std::vector<slot>(capacity)) };
+    size_ = 0;
+    for (auto& old : previous) {
+      if (old.serial != 0) {
+        insert(old.serial, std::move(*old.value));
+      }
+    }
+  }
+
+  std::vector<slot> slots_{};
+  std::size_t size_{};
+};
+
+}  // namespace adbus
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <boost/asio/any_io_executor.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/strand.hpp>
+
+namespace adbus {
+
+/// \brief A fixed set of strands over one executor, work is assigned to a strand by the hash of a key
+/// \note Threading model of a connection run on more than one thread:
+///  - the socket is created on a strand, e.g. asio::make_strand(pool), so the read loop, the writes and the
+///    completions of calls never run concurrently with each other
+///  - method calls are copied out of the receive buffer and posted to the shard of their object path, handlers of
+///    one object run one at a time in the order the calls were received, handlers of different objects run in
+///    parallel on the threads of the underlying executor
+///  - replies are handed back to the connection strand to be written
+/// The number of shards bounds the parallelism, it should be at least the number of threads running the executor.
+template <typename executor_t = boost::asio::any_io_executor>
+class sharded_executor {
+public:
+  using strand_type = boost::asio::strand<executor_t>;
+
+  sharded_executor(executor_t const& executor, std::size_t shards) {
+    strands_.reserve(shards == 0 ? 1 : shards);
+    for (std::size_t idx{}; idx < (shards == 0 ? 1 : shards); ++idx) {
+      strands_.emplace_back(executor);
+    }
+  }
+
+  [[nodiscard]] auto size() const noexcept -> std::size_t { return strands_.size(); }
+
+  /// \brief The strand work for key runs on, the same key always maps to the same strand
+  [[nodiscard]] auto shard_of(std::string_view key) const noexcept -> strand_type const& {
+    return strands_[std::hash<std::string_view>{}(key) % strands_.size()];
+  }
+
+  /// \brief Runs fn on the strand of key, after the work posted for key before it
+  void post(std::string_view key, auto&& fn) const {
+    boost::asio::post(shard_of(key), std::forward<decltype(fn)>(fn));
+  }
+
+private:
+  std::vector<strand_type> strands_{};
+};
+
+}  // namespace adbus
@@ -0,0 +1,376 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <adbus/protocol/header_view.hpp>
+#include <adbus/protocol/match_rule.hpp>
+#include <adbus/protocol/read.hpp>
+#include <adbus/protocol/signature.hpp>
+
+namespace adbus {
+
+/// \brief Index of signal subscriptions, a signal only visits the subscriptions which may match it
+/// \note Subscriptions are hashed by interface and then member, a rule without either is filed under the empty name,
+/// so a signal takes at most four lookups to find its candidates. Below that an exact path is hashed as well and a
+/// path_namespace is kept in a trie of path elements. Sender and arg0 are only compared on the candidates found.
+/// Subscribers with the same body type share a single decoded body per signal.
+/// Not synchronized. A dispatch is split in match, which reads the index, and deliver, which only holds on to the
+/// matched subscribers, so a lock guarding the router need not be held while callbacks run. A callback may subscribe
+/// and unsubscribe, a subscriber removed during a dispatch still gets the signal being delivered.
+class signal_router {
+  struct receiver;
+
+public:
+  using subscription_id = std::uint64_t;
+
+  signal_router() = default;
+  signal_router(signal_router const&) = delete;
+  auto operator=(signal_router const&) -> signal_router& = delete;
+
+  [[nodiscard]] auto size() const noexcept -> std::size_t { return subscriptions_.size(); }
+  [[nodiscard]] auto empty() const noexcept -> bool { return subscriptions_.empty(); }
+  /// \brief Number of interface and member pairs in the index, a pair is dropped along with its last subscription
+  [[nodiscard]] auto bucket_count() const noexcept -> std::size_t {
+    std::size_t output{};
+    for (auto const& [interface, members] : interfaces_) {
+      output += members.size();
+    }
+    return output;
+  }
+
+  /// \brief The subscribers matching a signal, found by match and called by deliver
+  class matches {
+  public:
+    [[nodiscard]] auto size() const noexcept -> std::size_t { return receivers_.size(); }
+    [[nodiscard]] auto empty() const noexcept -> bool { return receivers_.empty(); }
+
+  private:
+    friend signal_router;
+    // sorted by body type, shared with the subscriptions so they stay alive when unsubscribed in between
+    std::vector<std::shared_ptr<receiver>> receivers_{};
+  };
+
+  /// \brief Calls callback(header, body) for every signal matching rule which carries a body_t
+  template <typename body_t>
+  auto subscribe(protocol::match_rule rule,
+                 std::invocable<protocol::header::header_view const&, body_t const&> auto&& callback)
+      -> subscription_id {
+    auto const id{ ++last_id_ };
+    auto& added{ subscriptions_
+                     .try_emplace(id, id, std::move(rule),
+                                  std::make_shared<receiver>(
+                                      &deliver_as<body_t>,
+                                      [callback_mv = std::forward<decltype(callback)>(callback)](
+                                          protocol::header::header_view const& header, void const* body) mutable {
+                                        callback_mv(header, *static_cast<body_t const*>(body));
+                                      }))
+                     .first->second };
+    index(added);
+    return id;
+  }
+
+  auto unsubscribe(subscription_id id) -> bool {
+    auto found{ subscriptions_.find(id) };
+    if (found == subscriptions_.end()) {
+      return false;
+    }
+    unindex(found->second);
+    subscriptions_.erase(found);
+    return true;
+  }
+
+  /// \brief The rule of a subscription, nullptr if there is no such subscription
+  [[nodiscard]] auto rule(subscription_id id) const noexcept -> protocol::match_rule const* {
+    auto found{ subscriptions_.find(id) };
+    return found == subscriptions_.end() ? nullptr : &found->second.rule;
+  }
+
+  /// \brief Calls every subscriber matching signal
+  /// \return the number of callbacks invoked
+  auto dispatch(protocol::header::header_view const& signal) -> std::size_t {
+    matches found{};
+    match(signal, found);
+    return deliver(signal, found);
+  }
+
+  /// \brief Replaces output with the subscribers matching signal, the only part of a dispatch which reads the router
+  void match(protocol::header::header_view const& signal, matches& output) {
+    using std::string_view_literals::operator""sv;
+    output.receivers_.clear();
+    if (signal.type() != protocol::header::message_type_e::signal) {
+      return;
+    }
+    auto const interface{ signal.interface().value_or(""sv) };
+    auto const member{ signal.member().value_or(""sv) };
+    auto const path{ signal.path().value_or(""sv) };
+    auto const arg0{ first_string_argument(signal) };
+    for (auto const interface_key : { interface, ""sv }) {
+      auto members{ interfaces_.find(interface_key) };
+      if (members != interfaces_.end()) {
+        for (auto const member_key : { member, ""sv }) {
+          auto found{ members->second.find(member_key) };
+          if (found != members->second.end()) {
+            collect(found->second, signal, path, arg0, output.receivers_);
+          }
+          if (member.empty()) {
+            break;
+          }
+        }
+      }
+      if (interface.empty()) {
+        break;
+      }
+    }
+
+    // one decode per body type, matched subscriptions of the same type are next to each other after sorting
+    std::ranges::stable_sort(output.receivers_, std::less<>{}, &receiver::deliver);
+  }
+
+  /// \brief Calls the subscribers found by match, reads nothing of the router
+  /// \return the number of callbacks invoked
+  static auto deliver(protocol::header::header_view const& signal, matches const& found) -> std::size_t {
+    std::array<std::byte, 1024> arena_buffer{};
+    std::pmr::monotonic_buffer_resource arena{ arena_buffer.data(), arena_buffer.size() };
+    auto const& receivers{ found.receivers_ };
+    std::size_t invoked{};
+    for (auto first{ receivers.begin() }; first != receivers.end();) {
+      auto const last{ std::ranges::find_if(first, receivers.end(), [deliver_fn = (*first)->deliver](auto const& to) {
+        return to->deliver != deliver_fn;
+      }) };
+      invoked += (*first)->deliver(signal, &arena, std::span{ first, last });
+      arena.release();
+      first = last;
+    }
+    return invoked;
+  }
+
+private:
+  using callback_t = std::move_only_function<void(protocol::header::header_view const&, void const*)>;
+  using deliver_t = std::size_t (*)(protocol::header::header_view const&,
+                                    std::pmr::memory_resource*,
+                                    std::span<std::shared_ptr<receiver> const>);
+
+  // The callback of a subscription along with the decoder of its body type
+  struct receiver {
+    deliver_t deliver{};
+    callback_t callback{};
+  };
+
+  struct subscription {
+    subscription_id id{};
+    protocol::match_rule rule{};
+    std::shared_ptr<receiver> target{};
+  };
+
+  struct string_hash {
+    using is_transparent = void;
+    [[nodiscard]] auto operator()(std::string_view value) const noexcept -> std::size_t {
+      return std::hash<std::string_view>{}(value);
+    }
+  };
+
+  template <typename value_t>
+  using string_map = std::unordered_map<std::string, value_t, string_hash, std::equal_to<>>;
+
+  // A path element, subscribers of a path_namespace sit at the node of its last element
+  struct path_node {
+    std::vector<subscription*> subscribers{};
+    string_map<std::unique_ptr<path_node>> children{};
+
+    [[nodiscard]] auto empty() const noexcept -> bool { return subscribers.empty() && children.empty(); }
+  };
+
+  struct bucket {
+    std::vector<subscription*> any_path{};
+    string_map<std::vector<subscription*>> paths{};
+    path_node namespaces{};
+
+    [[nodiscard]] auto empty() const noexcept -> bool { return any_path.empty() && paths.empty() && namespaces.empty(); }
+  };
+
+  // Decodes the body once and hands it to every subscriber, which all expect a body_t
+  template <typename body_t>
+  static auto deliver_as(protocol::header::header_view const& signal,
+                         std::pmr::memory_resource* resource,
+                         std::span<std::shared_ptr<receiver> const> subscribers) -> std::size_t {
+    if (signal.signature() != protocol::type::signature_v<body_t>) {
+      return 0;
+    }
+    auto body{ protocol::read_dbus_binary<body_t>(signal.body(), signal.byte_order(), resource) };
+    if (!body) [[unlikely]] {
+      return 0;
+    }
+    for (auto const& to : subscribers) {
+      to->callback(signal, &*body);
+    }
+    return subscribers.size();
+  }
+
+  [[nodiscard]] static auto first_string_argument(protocol::header::header_view const& signal) noexcept
+      -> std::optional<std::string_view> {
+    auto const body{ signal.body() };
+    std::uint32_t size{};
+    if (!signal.signature().value_or("").starts_with('s') || body.size() < sizeof(size)) {
+      return std::nullopt;
+    }
+    std::memcpy(&size, body.data(), sizeof(size));
+    // the string is followed by its null terminator
+    if (body.size() - sizeof(size) <= size) [[unlikely]] {
+      return std::nullopt;
+    }
+    return body.substr(sizeof(size), size);
+  }
+
+  // Calls fn with every element of path, e.g. "a" and "b" of "/a/b"
+  static void for_each_element(std::string_view path, auto&& fn) {
+    while (!path.empty()) {
+      path.remove_prefix(1);
+      auto const element{ path.substr(0, path.find('/')) };
+      if (element.empty()) {
+        return;
+      }
+      if (!fn(element)) {
+        return;
+      }
+      path.remove_prefix(element.size());
+    }
+  }
+
+  static void collect(bucket const& candidates,
+                      protocol::header::header_view const& signal,
+                      std::string_view path,
+                      std::optional<std::string_view> arg0,
+                      std::vector<std::shared_ptr<receiver>>& output) {
+    auto add{ [&](std::vector<subscription*> const& subscribers) {
+      for (auto* sub : subscribers) {
+        if (sub->rule.matches(signal, arg0)) {
+          output.emplace_back(sub->target);
+        }
+      }
+    } };
+    add(candidates.any_path);
+    if (auto found{ candidates.paths.find(path) }; found != candidates.paths.end()) {
+      add(found->second);
+    }
+    path_node const* node{ &candidates.namespaces };
+    add(node->subscribers);
+    for_each_element(path, [&](std::string_view element) {
+      auto child{ node->children.find(element) };
+      if (child == node->children.end()) {
+        return false;
+      }
+      node = child->second.get();
+      add(node->subscribers);
+      return true;
+    });
+  }
+
+  // The bucket of rule, created when it is missing
+  [[nodiscard]] auto bucket_of(protocol::match_rule const& rule) -> bucket& {
+    auto members{ interfaces_.find(rule.interface) };
+    if (members == interfaces_.end()) {
+      members = interfaces_.emplace(rule.interface, string_map<bucket>{}).first;
+    }
+    auto found{ members->second.find(rule.member) };
+    if (found == members->second.end()) {
+      found = members->second.emplace(rule.member, bucket{}).first;
+    }
+    return found->second;
+  }
+
+  // The list of candidates which holds sub, created along with the path elements leading to it
+  [[nodiscard]] static auto subscribers_of(bucket& candidates, subscription const& sub) -> std::vector<subscription*>& {
+    if (!sub.rule.path.empty()) {
+      auto found{ candidates.paths.find(sub.rule.path) };
+      if (found == candidates.paths.end()) {
+        found = candidates.paths.emplace(sub.rule.path, std::vector<subscription*>{}).first;
+      }
+      return found->second;
+    }
+    if (!sub.rule.path_namespace.empty()) {
+      path_node* node{ &candidates.namespaces };
+      for_each_element(sub.rule.path_namespace, [&](std::string_view element) {
+        auto child{ node->children.find(element) };
+        if (child == node->children.end()) {
+          child = node->children.emplace(std::string{ element }, std::make_unique<path_node>()).first;
+        }
+        node = child->second.get();
+        return true;
+      });
+      return node->subscribers;
+    }
+    return candidates.any_path;
+  }
+
+  // Removes sub from the node of the remaining elements of path_namespace below node, drops the nodes left empty
+  // \return whether node is left empty
+  static auto unindex_namespace(path_node& node, std::string_view path_namespace, subscription const& sub) -> bool {
+    // the same elements as for_each_element, which stops at the first empty one
+    auto const rest{ path_namespace.empty() ? path_namespace : path_namespace.substr(1) };
+    auto const element{ rest.substr(0, rest.find('/')) };
+    if (element.empty()) {
+      std::erase(node.subscribers, &sub);
+      return node.empty();
+    }
+    auto child{ node.children.find(element) };
+    if (child != node.children.end() && unindex_namespace(*child->second, rest.substr(element.size()), sub)) {
+      node.children.erase(child);
+    }
+    return node.empty();
+  }
+
+  void index(subscription& sub) { subscribers_of(bucket_of(sub.rule), sub).emplace_back(&sub); }
+
+  // Looks the bucket up without creating anything, buckets and path elements left without subscribers are dropped
+  void unindex(subscription const& sub) {
+    auto members{ interfaces_.find(sub.rule.interface) };
+    if (members == interfaces_.end()) {
+      return;
+    }
+    auto found{ members->second.find(sub.rule.member) };
+    if (found == members->second.end()) {
+      return;
+    }
+    auto& candidates{ found->second };
+    if (!sub.rule.path.empty()) {
+      if (auto path{ candidates.paths.find(sub.rule.path) }; path != candidates.paths.end()) {
+        std::erase(path->second, &sub);
+        if (path->second.empty()) {
+          candidates.paths.erase(path);
+        }
+      }
+    } else if (!sub.rule.path_namespace.empty()) {
+      unindex_namespace(candidates.namespaces, sub.rule.path_namespace, sub);
+    } else {
+      std::erase(candidates.any_path, &sub);
+    }
+    if (candidates.empty()) {
+      members->second.erase(found);
+      if (members->second.empty()) {
+        interfaces_.erase(members);
+      }
+    }
+  }
+
+  // Values of an unordered_map stay in place, so the index refers to them by pointer
+  std::unordered_map<subscription_id, subscription> subscriptions_{};
+  string_map<string_map<bucket>> interfaces_{};
+  subscription_id last_id_{};
+};
+
+}  // namespace adbus
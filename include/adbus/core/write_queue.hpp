@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include <boost/asio/async_result.hpp>
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/dispatch.hpp>
+#include <boost/asio/write.hpp>
+
+#include <adbus/core/completion_slot.hpp>
+
+namespace adbus {
+
+/// \brief The outgoing messages of a connection, written one after the other in the order they were queued
+/// \note A composed asio::async_write is a series of write_some calls, two of them in flight on one stream interleave
+/// their partial writes and corrupt the stream. Every message of a connection goes through one queue which starts the
+/// next write once the previous one has completed. The queue lives on the executor of the stream, e.g. the connection
+/// strand, async_write may be called from any thread and hands the message over to it.
+template <typename stream_t>
+class write_queue {
+public:
+  using executor_type = typename stream_t::executor_type;
+
+  explicit write_queue(stream_t& stream) : stream_{ stream } {}
+  write_queue(write_queue const&) = delete;
+  auto operator=(write_queue const&) -> write_queue& = delete;
+
+  /// \brief Writes all of buffers after the messages queued before them, completes once they are written or failed
+  /// \note As with asio::async_write the memory referenced by buffers must stay valid until completion
+  auto async_write(std::vector<boost::asio::const_buffer> buffers,
+                   boost::asio::completion_token_for<void(std::error_code, std::size_t)> auto&& token) {
+    return boost::asio::async_initiate<decltype(token), void(std::error_code, std::size_t)>(
+        [this](auto handler, std::vector<boost::asio::const_buffer> buffers_mv) {
+          entry next{ std::move(buffers_mv) };
+          next.slot.emplace(std::move(handler), stream_.get_executor());
+          boost::asio::dispatch(stream_.get_executor(), [this, next_mv = std::move(next)]() mutable {
+            queue_.push_back(std::move(next_mv));
+            if (queue_.size() == 1) {
+              write_front();
+            }
+          });
+        },
+        token, std::move(buffers));
+  }
+
+  /// \brief Number of messages queued or being written, only meaningful on the executor of the stream
+  [[nodiscard]] auto size() const noexcept -> std::size_t { return queue_.size(); }
+
+private:
+  struct entry {
+    std::vector<boost::asio::const_buffer> buffers{};
+    completion_slot<void(std::error_code, std::size_t)> slot{};
+  };
+
+  // The front entry is the one being written, the others wait for it
+  void write_front() {
+    boost::asio::async_write(stream_, queue_.front().buffers, [this](std::error_code err, std::size_t size) {
+      auto done{ std::move(queue_.front().slot) };
+      queue_.pop_front();
+      // the next write starts before the handler runs, a handler which queues another message appends to it
+      if (!queue_.empty()) {
+        write_front();
+      }
+      done.complete(err, size);
+    });
+  }
+
+  stream_t& stream_;
+  std::deque<entry> queue_{};
+};
+
+}  // namespace adbus
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include <adbus/util/simd.hpp>
+
+namespace adbus::protocol::detail {
+
+// [A-Z][a-z][0-9]_, the characters every element of an object path or of a name may hold
+[[nodiscard]] constexpr auto is_word_char(char c) noexcept -> bool {
+  return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+struct char_scan {
+  static constexpr std::size_t npos{ std::string_view::npos };
+  // The first character which is neither a word character nor an allowed separator
+  std::size_t invalid{ npos };
+  // The second of the first two consecutive separators, only looked for when separators are allowed
+  std::size_t doubled{ npos };
+  constexpr auto operator==(char_scan const&) const noexcept -> bool = default;
+};
+
+/// \brief Classifies input from the index from on, one character at a time
+/// \note Stops at the first invalid character, a doubled separator before it is reported as well
+template <char separator, bool separator_allowed>
+[[nodiscard]] constexpr auto scan_chars_scalar(std::string_view input, std::size_t from) noexcept -> char_scan {
+  assert(from > 0 && "the character before from is compared for doubled separators");
+  char_scan output{};
+  for (std::size_t idx{ from }; idx < input.size(); ++idx) {
+    auto const c{ input[idx] };
+    if constexpr (separator_allowed) {
+      if (c == separator) {
+        if (input[idx - 1] == separator && output.doubled == char_scan::npos) {
+          output.doubled = idx;
+        }
+        continue;
+      }
+    }
+    if (!is_word_char(c)) {
+      output.invalid = idx;
+      return output;
+    }
+  }
+  return output;
+}
+
+#if defined(__SSE2__)
+// Lanes holding a word character, bytes above 0x7f are negative and fall outside every range
+[[nodiscard]] inline auto word_chars(__m128i chars) noexcept -> __m128i {
+  // setting 0x20 folds A-Z onto a-z and maps no other byte into a-z
+  auto const folded{ _mm_or_si128(chars, _mm_set1_epi8(0x20)) };
+  auto const letter{ _mm_and_si128(_mm_cmpgt_epi8(folded, _mm_set1_epi8('a' - 1)),
+                                   _mm_cmplt_epi8(folded, _mm_set1_epi8('z' + 1))) };
+  auto const digit{ _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8('0' - 1)),
+                                  _mm_cmplt_epi8(chars, _mm_set1_epi8('9' + 1))) };
+  return _mm_or_si128(_mm_or_si128(letter, digit), _mm_cmpeq_epi8(chars, _mm_set1_epi8('_')));
+}
+#endif
+
+#if defined(ADBUS_SIMD_DISPATCH)
+[[nodiscard]] __attribute__((target("avx2"))) inline auto word_chars(__m256i chars) noexcept -> __m256i {
+  auto const folded{ _mm256_or_si256(chars, _mm256_set1_epi8(0x20)) };
+  auto const letter{ _mm256_andnot_si256(_mm256_cmpgt_epi8(folded, _mm256_set1_epi8('z')),
+                                         _mm256_cmpgt_epi8(folded, _mm256_set1_epi8('a' - 1))) };
+  auto const digit{ _mm256_andnot_si256(_mm256_cmpgt_epi8(chars, _mm256_set1_epi8('9')),
+                                        _mm256_cmpgt_epi8(chars, _mm256_set1_epi8('0' - 1))) };
+  return _mm256_or_si256(_mm256_or_si256(letter, digit), _mm256_cmpeq_epi8(chars, _mm256_set1_epi8('_')));
+}
+#endif
+
+// Records the block at idx whose bit i is set for a doubled separator or an invalid character at idx + i, returns whether
+// the scan ends here
+constexpr auto record(char_scan& output, std::size_t idx, std::uint32_t doubled, std::uint32_t invalid) noexcept -> bool {
+  if (invalid != 0) {
+    // as the scalar scan, which stops there, doubled separators after the invalid character are not reported
+    doubled &= (invalid & (0U - invalid)) - 1U;
+  }
+  if (doubled != 0 && output.doubled == char_scan::npos) {
+    output.doubled = idx + static_cast<std::size_t>(std::countr_zero(doubled));
+  }
+  if (invalid != 0) {
+    output.invalid = idx + static_cast<std::size_t>(std::countr_zero(invalid));
+    return true;
+  }
+  return false;
+}
+
+#if defined(ADBUS_SIMD_DISPATCH)
+// Classifies the whole blocks of 32 characters from idx on, leaves idx at the first character it did not classify
+// \return whether the scan ends in one of the blocks
+template <char separator, bool separator_allowed>
+__attribute__((target("avx2"))) inline auto scan_blocks_avx2(std::string_view input,
+                                                              std::size_t& idx,
+                                                              char_scan& output) noexcept -> bool {
+  auto const* const data{ input.data() };
+  for (; idx + 32 <= input.size(); idx += 32) {
+    auto const chars{ _mm256_loadu_si256(reinterpret_cast<__m256i const*>(data + idx)) };
+    auto valid{ word_chars(chars) };
+    std::uint32_t doubled{};
+    if constexpr (separator_allowed) {
+      auto const separators{ _mm256_cmpeq_epi8(chars, _mm256_set1_epi8(separator)) };
+      valid = _mm256_or_si256(valid, separators);
+      // the same characters shifted by one, a separator preceded by another
+      auto const previous{ _mm256_loadu_si256(reinterpret_cast<__m256i const*>(data + idx - 1)) };
+      doubled = static_cast<std::uint32_t>(_mm256_movemask_epi8(
+          _mm256_and_si256(separators, _mm256_cmpeq_epi8(previous, _mm256_set1_epi8(separator)))));
+    }
+    auto const invalid{ ~static_cast<std::uint32_t>(_mm256_movemask_epi8(valid)) };
+    if (record(output, idx, doubled, invalid)) {
+      return true;
+    }
+  }
+  return false;
+}
+#endif
+
+#if defined(__SSE2__)
+// Classifies the whole blocks of 16 characters from idx on, leaves idx at the first character it did not classify
+// \return whether the scan ends in one of the blocks
+template <char separator, bool separator_allowed>
+inline auto scan_blocks_sse2(std::string_view input, std::size_t& idx, char_scan& output) noexcept -> bool {
+  auto const* const data{ input.data() };
+  for (; idx + 16 <= input.size(); idx += 16) {
+    auto const chars{ _mm_loadu_si128(reinterpret_cast<__m128i const*>(data + idx)) };
+    auto valid{ word_chars(chars) };
+    std::uint32_t doubled{};
+    if constexpr (separator_allowed) {
+      auto const separators{ _mm_cmpeq_epi8(chars, _mm_set1_epi8(separator)) };
+      valid = _mm_or_si128(valid, separators);
+      auto const previous{ _mm_loadu_si128(reinterpret_cast<__m128i const*>(data + idx - 1)) };
+      doubled = static_cast<std::uint32_t>(
+          _mm_movemask_epi8(_mm_and_si128(separators, _mm_cmpeq_epi8(previous, _mm_set1_epi8(separator)))));
+    }
+    auto const invalid{ ~static_cast<std::uint32_t>(_mm_movemask_epi8(valid)) & 0xffffU };
+    if (record(output, idx, doubled, invalid)) {
+      return true;
+    }
+  }
+  return false;
+}
+#endif
+
+/// \brief Same result as scan_chars_scalar, classifying 32 characters at a time when level allows AVX2 and 16 with the
+/// SSE2 of the x86-64 baseline, the characters after the last whole block take the scalar path
+template <char separator, bool separator_allowed>
+[[nodiscard]] inline auto scan_chars_simd(std::string_view input,
+                                          std::size_t from,
+                                          [[maybe_unused]] util::simd_level level) noexcept -> char_scan {
+  assert(from > 0 && "the character before from is compared for doubled separators");
+  char_scan output{};
+  std::size_t idx{ from };
+#if defined(ADBUS_SIMD_DISPATCH)
+  if (level >= util::simd_level::avx2 && scan_blocks_avx2<separator, separator_allowed>(input, idx, output)) {
+    return output;
+  }
+#endif
+#if defined(__SSE2__)
+  if (scan_blocks_sse2<separator, separator_allowed>(input, idx, output)) {
+    return output;
+  }
+#endif
+  auto const rest{ scan_chars_scalar<separator, separator_allowed>(input, idx) };
+  if (output.doubled == char_scan::npos) {
+    output.doubled = rest.doubled;
+  }
+  output.invalid = rest.invalid;
+  return output;
+}
+
+/// \brief Same result as scan_chars_scalar, vectorized with the widest extension the CPU supports
+/// \note Constant evaluation takes the scalar path
+template <char separator, bool separator_allowed>
+[[nodiscard]] constexpr auto scan_chars(std::string_view input, std::size_t from) noexcept -> char_scan {
+  if consteval {
+    return scan_chars_scalar<separator, separator_allowed>(input, from);
+  } else {
+    return scan_chars_simd<separator, separator_allowed>(input, from, util::supported_simd());
+  }
+}
+
+}  // namespace adbus::protocol::detail
@@ -0,0 +1,278 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include <adbus/core/context.hpp>
+
+namespace adbus::protocol {
+
+[[nodiscard]] constexpr auto complete_type_size(std::string_view signature) noexcept -> std::size_t;
+
+/// \brief Length of the dict entry at the beginning of signature, e.g. "{sv}", 0 if there is none
+[[nodiscard]] constexpr auto dict_entry_size(std::string_view signature) noexcept -> std::size_t {
+  // the key is a basic type
+  if (signature.size() < 2 || signature.front() != '{' || complete_type_size(signature.substr(1, 1)) != 1 ||
+      signature[1] == 'v') {
+    return 0;
+  }
+  auto const value{ complete_type_size(signature.substr(2)) };
+  if (value == 0 || 2 + value >= signature.size() || signature[2 + value] != '}') {
+    return 0;
+  }
+  return 3 + value;
+}
+
+/// \brief Length of the single complete type at the beginning of signature, 0 if there is none
+[[nodiscard]] constexpr auto complete_type_size(std::string_view signature) noexcept -> std::size_t {
+  if (signature.empty()) {
+    return 0;
+  }
+  switch (signature.front()) {
+    case 'y':
+    case 'b':
+    case 'n':
+    case 'q':
+    case 'i':
+    case 'u':
+    case 'x':
+    case 't':
+    case 'd':
+    case 'h':
+    case 's':
+    case 'o':
+    case 'g':
+    case 'v':
+      return 1;
+    case 'a': {
+      // a dict entry is only allowed as the element of an array
+      auto const element{ signature.substr(1).starts_with('{') ? dict_entry_size(signature.substr(1))
+                                                               : complete_type_size(signature.substr(1)) };
+      return element == 0 ? 0 : 1 + element;
+    }
+    case '(': {
+      std::size_t idx{ 1 };
+      while (idx < signature.size() && signature[idx] != ')') {
+        auto const member{ complete_type_size(signature.substr(idx)) };
+        if (member == 0) {
+          return 0;
+        }
+        idx += member;
+      }
+      // empty structs are not allowed
+      return idx < signature.size() && idx > 1 ? idx + 1 : 0;
+    }
+    default:
+      return 0;
+  }
+}
+
+static_assert(complete_type_size("a{sv}i") == 5);
+static_assert(complete_type_size("(ii)") == 4);
+static_assert(complete_type_size("()") == 0);
+static_assert(complete_type_size("a{vs}") == 0);
+static_assert(complete_type_size("a") == 0);
+static_assert(complete_type_size("{sv}") == 0);
+
+namespace detail {
+
+// The specification allows 32 levels of arrays and 32 levels of structs
+inline constexpr std::size_t max_type_depth{ 64 };
+
+[[nodiscard]] constexpr auto alignment_of(char code) noexcept -> std::size_t {
+  switch (code) {
+    case 'n':
+    case 'q':
+      return 2;
+    case 'b':
+    case 'i':
+    case 'u':
+    case 'h':
+    case 's':
+    case 'o':
+    case 'a':
+      return 4;
+    case 'x':
+    case 't':
+    case 'd':
+    case '(':
+    case '{':
+      return 8;
+    default:
+      return 1;
+  }
+}
+
+// Size of the fixed types, 0 for every other type
+[[nodiscard]] constexpr auto fixed_size_of(char code) noexcept -> std::size_t {
+  switch (code) {
+    case 'y':
+      return 1;
+    case 'n':
+    case 'q':
+      return 2;
+    case 'b':
+    case 'i':
+    case 'u':
+    case 'h':
+      return 4;
+    case 'x':
+    case 't':
+    case 'd':
+      return 8;
+    default:
+      return 0;
+  }
+}
+
+/// \brief Steps over a value of any complete type without decoding it, e.g. a header field of an unknown code
+/// \note Alignment is relative to the beginning of bytes. Only the framing is checked: lengths, terminators, the signatures
+/// held by variants and the nesting depth.
+struct value_skipper {
+  std::string_view bytes{};
+  std::size_t idx{};
+  // the bytes are in the other byte order than the host
+  bool byte_swap{};
+  error err{};
+
+  constexpr auto fail(error_code code) noexcept -> bool {
+    err = error{ code, idx };
+    return false;
+  }
+
+  constexpr auto align(char code) noexcept -> bool {
+    auto const alignment{ alignment_of(code) };
+    auto const padding{ (alignment - (idx % alignment)) % alignment };
+    if (idx + padding > bytes.size()) [[unlikely]] {
+      return fail(error_code::out_of_range);
+    }
+    idx += padding;
+    return true;
+  }
+
+  constexpr auto read_u32(std::uint32_t& value) noexcept -> bool {
+    if (!align('u') || idx + sizeof(value) > bytes.size()) [[unlikely]] {
+      return fail(error_code::out_of_range);
+    }
+    std::array<char, sizeof(value)> raw{};
+    std::copy_n(bytes.begin() + static_cast<std::ptrdiff_t>(idx), raw.size(), raw.begin());
+    value = std::bit_cast<std::uint32_t>(raw);
+    if (byte_swap) [[unlikely]] {
+      value = std::byteswap(value);
+    }
+    idx += sizeof(value);
+    return true;
+  }
+
+  // size bytes followed by a null terminator
+  constexpr auto skip_text(std::size_t size) noexcept -> bool {
+    if (idx + size >= bytes.size() || bytes[idx + size] != '\0') [[unlikely]] {
+      return fail(error_code::out_of_range);
+    }
+    idx += size + 1;
+    return true;
+  }
+
+  // Skips values of the complete types in signature one after the other
+  constexpr auto skip_sequence(std::string_view signature, std::size_t depth) noexcept -> bool {
+    while (!signature.empty()) {
+      auto const size{ complete_type_size(signature) };
+      if (size == 0) [[unlikely]] {
+        return fail(error_code::invalid_signature);
+      }
+      if (!skip(signature.substr(0, size), depth)) [[unlikely]] {
+        return false;
+      }
+      signature.remove_prefix(size);
+    }
+    return true;
+  }
+
+  // Skips a value of signature, which is a single complete type
+  constexpr auto skip(std::string_view signature, std::size_t depth) noexcept -> bool {
+    if (depth > max_type_depth) [[unlikely]] {
+      return fail(error_code::nesting_too_deep);
+    }
+    auto const code{ signature.front() };
+    if (!align(code)) [[unlikely]] {
+      return false;
+    }
+    if (auto const size{ fixed_size_of(code) }; size > 0) {
+      if (idx + size > bytes.size()) [[unlikely]] {
+        return fail(error_code::out_of_range);
+      }
+      idx += size;
+      return true;
+    }
+    switch (code) {
+      case 's':
+      case 'o': {
+        std::uint32_t size{};
+        return read_u32(size) && skip_text(size);
+      }
+      case 'g':
+      case 'v': {
+        if (idx >= bytes.size()) [[unlikely]] {
+          return fail(error_code::out_of_range);
+        }
+        auto const size{ static_cast<std::uint8_t>(bytes[idx++]) };
+        auto const contained{ bytes.substr(idx, size) };
+        if (!skip_text(size)) [[unlikely]] {
+          return false;
+        }
+        if (code == 'g') {
+          return true;
+        }
+        if (contained.empty() || complete_type_size(contained) != contained.size()) [[unlikely]] {
+          return fail(error_code::invalid_signature);
+        }
+        return skip(contained, depth + 1);
+      }
+      case 'a': {
+        std::uint32_t length{};
+        if (!read_u32(length)) [[unlikely]] {
+          return false;
+        }
+        auto const element{ signature.substr(1) };
+        // the padding to the first element is not part of the length, it is there even for an empty array
+        if (!align(element.front())) [[unlikely]] {
+          return false;
+        }
+        if (length > bytes.size() - idx) [[unlikely]] {
+          return fail(error_code::out_of_range);
+        }
+        auto const end{ idx + length };
+        if (fixed_size_of(element.front()) > 0) {
+          // elements of a fixed type are packed without padding between them
+          if (length % fixed_size_of(element.front()) != 0) [[unlikely]] {
+            return fail(error_code::out_of_range);
+          }
+          idx = end;
+          return true;
+        }
+        while (idx < end) {
+          if (!skip(element, depth + 1)) [[unlikely]] {
+            return false;
+          }
+        }
+        if (idx != end) [[unlikely]] {
+          return fail(error_code::out_of_range);
+        }
+        return true;
+      }
+      case '(':
+      case '{':
+        return skip_sequence(signature.substr(1, signature.size() - 2), depth + 1);
+      default:
+        return fail(error_code::invalid_signature);
+    }
+  }
+};
+
+}  // namespace detail
+
+}  // namespace adbus::protocol
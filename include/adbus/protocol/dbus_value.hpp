@@ -0,0 +1,402 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <expected>
+#include <iterator>
+#include <memory_resource>
+#include <optional>
+#include <string_view>
+
+#include <adbus/core/context.hpp>
+#include <adbus/protocol/complete_type.hpp>
+#include <adbus/protocol/header_view.hpp>
+#include <adbus/protocol/signature.hpp>
+#include <adbus/util/concepts.hpp>
+
+namespace adbus::protocol {
+
+namespace detail {
+struct value_parser;
+}
+
+/// \brief A value of any D-Bus type, decoded at run time by following a signature
+/// \note Nodes are allocated from the memory resource given to parse_dbus_value and are never freed one by one, use an
+/// arena such as std::pmr::monotonic_buffer_resource. Strings, object paths and signatures are views into the parsed
+/// bytes, and so is an array of a fixed type, e.g. "ay" or "ad", which is a single node without children whatever its
+/// length. Both the resource and the bytes must outlive the value.
+class dbus_value {
+public:
+  class iterator {
+  public:
+    using value_type = dbus_value;
+    using difference_type = std::ptrdiff_t;
+
+    constexpr iterator() noexcept = default;
+    constexpr explicit iterator(dbus_value const* node) noexcept : node_{ node } {}
+
+    [[nodiscard]] constexpr auto operator*() const noexcept -> dbus_value const& { return *node_; }
+    [[nodiscard]] constexpr auto operator->() const noexcept -> dbus_value const* { return node_; }
+    constexpr auto operator++() noexcept -> iterator& {
+      node_ = node_->next_;
+      return *this;
+    }
+    constexpr auto operator++(int) noexcept -> iterator {
+      auto copy{ *this };
+      ++*this;
+      return copy;
+    }
+    constexpr auto operator==(iterator const&) const noexcept -> bool = default;
+
+  private:
+    dbus_value const* node_{};
+  };
+
+  struct children_view {
+    dbus_value const* first{};
+    [[nodiscard]] constexpr auto begin() const noexcept -> iterator { return iterator{ first }; }
+    [[nodiscard]] constexpr auto end() const noexcept -> iterator { return {}; }
+  };
+
+  /// \brief The type code, e.g. 'u', 's', 'a' or 'v', a struct is 'r' and a dict entry is 'e'
+  /// \note The values of a message body are the children of a struct whose signature is the body signature
+  [[nodiscard]] constexpr auto code() const noexcept -> char { return code_; }
+  /// \brief The complete signature of the value, e.g. "a{sv}"
+  [[nodiscard]] constexpr auto signature() const noexcept -> std::string_view { return signature_; }
+  [[nodiscard]] constexpr auto is_container() const noexcept -> bool {
+    return code_ == 'a' || code_ == 'r' || code_ == 'e' || code_ == 'v';
+  }
+
+  /// \brief Elements of an array, members of a struct or dict entry, or the single value held by a variant
+  /// \note An array of a fixed type has no children, see fixed_elements
+  [[nodiscard]] constexpr auto children() const noexcept -> children_view { return { first_ }; }
+  /// \brief Number of children, or of elements of an array of a fixed type
+  [[nodiscard]] constexpr auto size() const noexcept -> std::size_t { return size_; }
+
+  /// \brief Whether the value is an array of a fixed type, e.g. "ai", whose elements are read with element<T>
+  [[nodiscard]] constexpr auto is_fixed_array() const noexcept -> bool {
+    return code_ == 'a' && detail::fixed_size_of(signature_[1]) > 0;
+  }
+  /// \brief The elements of an array of a fixed type as they are in the parsed bytes, packed and in the byte order of
+  /// the message, empty for any other value
+  [[nodiscard]] constexpr auto fixed_elements() const noexcept -> std::string_view {
+    return is_fixed_array() ? text_ : std::string_view{};
+  }
+  /// \brief Element index of an array of a fixed type as T, in the byte order of the host
+  /// \return nullopt if the value is not an array of T or index is out of range
+  template <typename T>
+  [[nodiscard]] constexpr auto element(std::size_t index) const noexcept -> std::optional<T> {
+    static_assert(adbus::type::fixed<T>, "the elements of a fixed array are fixed types");
+    if (!is_fixed_array() || !holds<T>(signature_[1]) || index >= size_) {
+      return std::nullopt;
+    }
+    auto const size{ detail::fixed_size_of(signature_[1]) };
+    std::uint64_t bits{};
+    std::memcpy(&bits, text_.data() + index * size, size);
+    if (byte_swap_) [[unlikely]] {
+      auto* const first{ reinterpret_cast<unsigned char*>(&bits) };
+      std::reverse(first, first + size);
+    }
+    return from_bits<T>(bits);
+  }
+
+  /// \brief The value as T, a fixed type or std::string_view for strings, object paths and signatures
+  /// \return nullopt if the value is of another type
+  template <typename T>
+  [[nodiscard]] constexpr auto get() const noexcept -> std::optional<T> {
+    if constexpr (std::same_as<T, std::string_view>) {
+      if (code_ == 's' || code_ == 'o' || code_ == 'g') {
+        return text_;
+      }
+      return std::nullopt;
+    } else {
+      static_assert(adbus::type::fixed<T>, "a dbus_value holds fixed types or strings");
+      if (!holds<T>(code_)) {
+        return std::nullopt;
+      }
+      return from_bits<T>(bits_);
+    }
+  }
+
+  /// \brief Calls fn with the value, fixed types as their C++ type, strings, object paths and signatures as
+  /// std::string_view and containers as the node itself, whose children are left to fn
+  constexpr void visit(auto&& fn) const {
+    switch (code_) {
+      case 'y': fn(*get<std::uint8_t>()); break;
+      case 'b': fn(*get<bool>()); break;
+      case 'n': fn(*get<std::int16_t>()); break;
+      case 'q': fn(*get<std::uint16_t>()); break;
+      case 'i': fn(*get<std::int32_t>()); break;
+      case 'u':
+      case 'h': fn(*get<std::uint32_t>()); break;
+      case 'x': fn(*get<std::int64_t>()); break;
+      case 't': fn(*get<std::uint64_t>()); break;
+      case 'd': fn(*get<double>()); break;
+      case 's':
+      case 'o':
+      case 'g': fn(text_); break;
+      default: fn(*this); break;
+    }
+  }
+
+private:
+  friend struct detail::value_parser;
+
+  // Whether a value of code is read as T, a unix fd is the index of the descriptor, a UINT32
+  template <typename T>
+  [[nodiscard]] static constexpr auto holds(char code) noexcept -> bool {
+    return code == type::signature_v<T>.front() || (code == 'h' && std::same_as<T, std::uint32_t>);
+  }
+
+  // T from the first bytes of bits, which are in the byte order of the host
+  template <typename T>
+  [[nodiscard]] static constexpr auto from_bits(std::uint64_t bits) noexcept -> T {
+    if constexpr (std::same_as<T, bool>) {
+      return bits != 0;
+    } else {
+      T output{};
+      std::memcpy(&output, &bits, sizeof(T));
+      return output;
+    }
+  }
+
+  char code_{};
+  // the elements of a fixed array are in the other byte order than the host
+  bool byte_swap_{};
+  std::uint32_t size_{};
+  std::string_view signature_{};
+  // the bytes of a fixed type
+  std::uint64_t bits_{};
+  // a string, object path or signature, or the elements of a fixed array
+  std::string_view text_{};
+  dbus_value* first_{};
+  dbus_value* next_{};
+};
+
+namespace detail {
+
+// Recursive descent over the signature, building the nodes as the bytes are read
+struct value_parser {
+  std::string_view bytes{};
+  std::size_t idx{};
+  std::pmr::polymorphic_allocator<> allocator{};
+  // the bytes are in the other byte order than the host
+  bool byte_swap{};
+  error err{};
+
+  auto fail(error_code code) noexcept -> dbus_value* {
+    err = error{ code, idx };
+    return nullptr;
+  }
+
+  auto align(char code) noexcept -> bool {
+    auto const alignment{ alignment_of(code) };
+    auto const padding{ (alignment - (idx % alignment)) % alignment };
+    if (idx + padding > bytes.size()) [[unlikely]] {
+      fail(error_code::out_of_range);
+      return false;
+    }
+    idx += padding;
+    return true;
+  }
+
+  auto read_u32(std::uint32_t& value) noexcept -> bool {
+    if (!align('u') || idx + sizeof(value) > bytes.size()) [[unlikely]] {
+      fail(error_code::out_of_range);
+      return false;
+    }
+    std::memcpy(&value, bytes.data() + idx, sizeof(value));
+    if (byte_swap) [[unlikely]] {
+      value = std::byteswap(value);
+    }
+    idx += sizeof(value);
+    return true;
+  }
+
+  // a string of size bytes followed by its null terminator
+  auto read_text(std::size_t size, std::string_view& text) noexcept -> bool {
+    if (idx + size >= bytes.size() || bytes[idx + size] != '\0') [[unlikely]] {
+      fail(error_code::out_of_range);
+      return false;
+    }
+    text = bytes.substr(idx, size);
+    idx += size + 1;
+    return true;
+  }
+
+  auto make_node(char code, std::string_view signature) -> dbus_value* {
+    auto* node{ allocator.new_object<dbus_value>() };
+    node->code_ = code;
+    node->signature_ = signature;
+    return node;
+  }
+
+  // Parses values of the complete types in signature one after the other as the children of parent
+  auto parse_sequence(dbus_value* parent, std::string_view signature, std::size_t depth) -> bool {
+    dbus_value** tail{ &parent->first_ };
+    while (!signature.empty()) {
+      auto const size{ complete_type_size(signature) };
+      if (size == 0) [[unlikely]] {
+        fail(error_code::invalid_signature);
+        return false;
+      }
+      auto* child{ parse(signature.substr(0, size), depth) };
+      if (child == nullptr) [[unlikely]] {
+        return false;
+      }
+      *tail = child;
+      tail = &child->next_;
+      ++parent->size_;
+      signature.remove_prefix(size);
+    }
+    return true;
+  }
+
+  // Parses a value of signature, which is a single complete type
+  auto parse(std::string_view signature, std::size_t depth) -> dbus_value* {
+    if (depth > max_type_depth) [[unlikely]] {
+      return fail(error_code::nesting_too_deep);
+    }
+    auto const code{ signature.front() };
+    if (!align(code)) [[unlikely]] {
+      return nullptr;
+    }
+    if (auto const size{ fixed_size_of(code) }; size > 0) {
+      if (idx + size > bytes.size()) [[unlikely]] {
+        return fail(error_code::out_of_range);
+      }
+      auto* node{ make_node(code, signature) };
+      std::memcpy(&node->bits_, bytes.data() + idx, size);
+      if (byte_swap) [[unlikely]] {
+        // get() reads the value from the first bytes of bits_
+        auto* const first{ reinterpret_cast<unsigned char*>(&node->bits_) };
+        std::reverse(first, first + size);
+      }
+      idx += size;
+      return node;
+    }
+    switch (code) {
+      case 's':
+      case 'o': {
+        std::uint32_t size{};
+        auto* node{ make_node(code, signature) };
+        if (!read_u32(size) || !read_text(size, node->text_)) [[unlikely]] {
+          return nullptr;
+        }
+        return node;
+      }
+      case 'g': {
+        if (idx >= bytes.size()) [[unlikely]] {
+          return fail(error_code::out_of_range);
+        }
+        auto const size{ static_cast<std::uint8_t>(bytes[idx++]) };
+        auto* node{ make_node(code, signature) };
+        if (!read_text(size, node->text_)) [[unlikely]] {
+          return nullptr;
+        }
+        return node;
+      }
+      case 'v': {
+        if (idx >= bytes.size()) [[unlikely]] {
+          return fail(error_code::out_of_range);
+        }
+        auto const size{ static_cast<std::uint8_t>(bytes[idx++]) };
+        std::string_view contained{};
+        if (!read_text(size, contained)) [[unlikely]] {
+          return nullptr;
+        }
+        if (contained.empty() || complete_type_size(contained) != contained.size()) [[unlikely]] {
+          return fail(error_code::invalid_signature);
+        }
+        auto* node{ make_node(code, signature) };
+        if (!parse_sequence(node, contained, depth + 1)) [[unlikely]] {
+          return nullptr;
+        }
+        return node;
+      }
+      case 'a': {
+        std::uint32_t length{};
+        if (!read_u32(length)) [[unlikely]] {
+          return nullptr;
+        }
+        auto const element{ signature.substr(1) };
+        // the padding to the first element is not part of the length, it is there even for an empty array
+        if (!align(element.front())) [[unlikely]] {
+          return nullptr;
+        }
+        if (length > bytes.size() - idx) [[unlikely]] {
+          return fail(error_code::out_of_range);
+        }
+        auto const end{ idx + length };
+        auto* node{ make_node(code, signature) };
+        if (auto const size{ fixed_size_of(element.front()) }; size > 0) {
+          // elements of a fixed type are packed without padding between them, a single node views all of them
+          if (length % size != 0) [[unlikely]] {
+            return fail(error_code::out_of_range);
+          }
+          node->text_ = bytes.substr(idx, length);
+          node->size_ = static_cast<std::uint32_t>(length / size);
+          node->byte_swap_ = byte_swap;
+          idx = end;
+          return node;
+        }
+        dbus_value** tail{ &node->first_ };
+        while (idx < end) {
+          auto* child{ parse(element, depth + 1) };
+          if (child == nullptr) [[unlikely]] {
+            return nullptr;
+          }
+          *tail = child;
+          tail = &child->next_;
+          ++node->size_;
+        }
+        if (idx != end) [[unlikely]] {
+          return fail(error_code::out_of_range);
+        }
+        return node;
+      }
+      case '(':
+      case '{': {
+        auto* node{ make_node(code == '(' ? 'r' : 'e', signature) };
+        if (!parse_sequence(node, signature.substr(1, signature.size() - 2), depth + 1)) [[unlikely]] {
+          return nullptr;
+        }
+        return node;
+      }
+      default:
+        return fail(error_code::invalid_signature);
+    }
+  }
+};
+
+}  // namespace detail
+
+/// \brief Parses bytes holding values of the types in signature, e.g. a message body and its signature
+/// \return a struct whose children are the values, allocated from resource
+/// \note Alignment is relative to the beginning of bytes, the body of a message starts on an 8-byte boundary so it can be
+/// parsed on its own. Fixed values are converted from order, the byte order of the message, to the order of the host.
+[[nodiscard]] inline auto parse_dbus_value(std::string_view signature,
+                                           std::string_view bytes,
+                                           std::pmr::memory_resource* resource,
+                                           std::endian order = std::endian::native)
+    -> std::expected<dbus_value const*, error> {
+  detail::value_parser parser{ .bytes = bytes,
+                               .allocator = std::pmr::polymorphic_allocator<>{ resource },
+                               .byte_swap = order != std::endian::native };
+  auto* root{ parser.make_node('r', signature) };
+  if (!parser.parse_sequence(root, signature, 0)) [[unlikely]] {
+    return std::unexpected{ parser.err };
+  }
+  return root;
+}
+
+/// \brief Parses the body of message by its signature field
+[[nodiscard]] inline auto parse_dbus_value(header::header_view const& message, std::pmr::memory_resource* resource)
+    -> std::expected<dbus_value const*, error> {
+  return parse_dbus_value(message.signature().value_or(""), message.body(), resource, message.byte_order());
+}
+
+}  // namespace adbus::protocol
@@ -0,0 +1,195 @@
+#pragma once
+
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <tuple>
+#include <type_traits>
+
+#include <glaze/core/common.hpp>
+#include <glaze/core/reflection_tuple.hpp>
+
+#include <adbus/util/byteswap.hpp>
+#include <adbus/util/concepts.hpp>
+
+namespace adbus::protocol {
+
+namespace detail {
+
+// The I-th member of value, in the order it is marshalled
+template <typename T, std::size_t I>
+constexpr auto member_at(auto&& value) -> decltype(auto) {
+  constexpr auto N = glz::reflection_count<T>;
+  using Element = glz::detail::glaze_tuple_element<I, N, T>;
+  if constexpr (glz::detail::reflectable<T>) {
+    return glz::detail::get_member(value, std::get<I>(glz::detail::reflection_tuple<T>(value)));
+  } else {
+    return glz::detail::get_member(value,
+                                   glz::get<Element::member_index>(glz::get<I>(glz::meta_v<std::decay_t<T>>)));
+  }
+}
+
+template <typename T, std::size_t I>
+inline constexpr bool skipped_member_v = [] {
+  using val_t = std::remove_cvref_t<typename glz::detail::glaze_tuple_element<I, glz::reflection_count<T>, T>::type>;
+  return std::same_as<val_t, glz::hidden> || std::same_as<val_t, glz::skip>;
+}();
+
+template <typename T, std::size_t I>
+using member_t = std::remove_cvref_t<decltype(member_at<T, I>(std::declval<T&>()))>;
+
+template <typename T>
+struct fixed_layout;
+
+template <typename T>
+consteval auto fixed_members() -> bool;
+
+}  // namespace detail
+
+/// \brief A struct made only of fixed types, enums of them and such structs, so every member is marshalled at the same
+/// offset from the 8-byte aligned beginning of the struct whatever the values are
+template <typename T>
+concept fixed_struct = (glz::detail::glaze_object_t<T> || glz::detail::reflectable<T>) && !is_header<T> &&
+                       detail::fixed_members<T>();
+
+namespace detail {
+
+// Marshalled size and alignment of a member of a fixed_struct
+template <typename T>
+struct fixed_member;
+
+template <typename T>
+  requires(adbus::type::fixed<T> && !std::same_as<T, bool>)
+struct fixed_member<T> {
+  static constexpr std::size_t size{ sizeof(T) };
+  static constexpr std::size_t alignment{ sizeof(T) };
+};
+
+template <>
+struct fixed_member<bool> {
+  // marshalled as UINT32
+  static constexpr std::size_t size{ sizeof(std::uint32_t) };
+  static constexpr std::size_t alignment{ sizeof(std::uint32_t) };
+};
+
+template <typename T>
+  requires(std::is_enum_v<T> && !glz::detail::glaze_enum_t<T> && adbus::type::fixed<std::underlying_type_t<T>>)
+struct fixed_member<T> : fixed_member<std::underlying_type_t<T>> {};
+
+template <fixed_struct T>
+struct fixed_member<T> {
+  static constexpr std::size_t size{ fixed_layout<T>::size };
+  static constexpr std::size_t alignment{ 8 };
+};
+
+template <typename T>
+consteval auto fixed_members() -> bool {
+  constexpr auto N = glz::reflection_count<T>;
+  // empty structs are not allowed by the specification
+  if constexpr (N == 0) {
+    return false;
+  }
+  return []<std::size_t... I>(std::index_sequence<I...>) {
+    return ([] {
+      if constexpr (skipped_member_v<T, I>) {
+        return true;
+      } else if constexpr (std::is_const_v<std::remove_reference_t<decltype(member_at<T, I>(std::declval<T&>()))>>) {
+        // decoded in place, so every member must be writable
+        return false;
+      } else {
+        return requires { fixed_member<member_t<T, I>>::size; };
+      }
+    }() && ...);
+  }(std::make_index_sequence<N>{});
+}
+
+/// \brief Offsets of the members of a fixed_struct from the 8-byte aligned beginning of the struct
+/// \note A skipped member takes no bytes, its offset is the one of the next member
+template <typename T>
+struct fixed_layout {
+  static constexpr auto N = glz::reflection_count<T>;
+
+  static constexpr auto offsets = [] {
+    std::array<std::size_t, N> output{};
+    std::size_t idx{};
+    glz::for_each<N>([&](auto I) {
+      if constexpr (skipped_member_v<T, I>) {
+        output[I] = idx;
+      } else {
+        using member = fixed_member<member_t<T, I>>;
+        idx += (member::alignment - (idx % member::alignment)) % member::alignment;
+        output[I] = idx;
+        idx += member::size;
+      }
+    });
+    return output;
+  }();
+
+  static constexpr std::size_t size = [] {
+    std::size_t last{};
+    glz::for_each<N>([&](auto I) {
+      if constexpr (!skipped_member_v<T, I>) {
+        last = offsets[I] + fixed_member<member_t<T, I>>::size;
+      }
+    });
+    return last;
+  }();
+
+  // Writes every member at its offset from output, which holds at least size bytes, the bytes in between are zeroed
+  static constexpr void encode(auto const& value, void* output) noexcept {
+    auto* const bytes{ static_cast<char*>(output) };
+    std::memset(bytes, 0, size);
+    glz::for_each<N>([&](auto I) {
+      if constexpr (!skipped_member_v<T, I>) {
+        encode_member(member_at<T, I>(value), bytes + offsets[I]);
+      }
+    });
+  }
+
+  // Reads every member from its offset from input, which holds at least size bytes, in the other byte order when
+  // byte_swap is set
+  static constexpr void decode(auto& value, void const* input, bool byte_swap = false) noexcept {
+    auto const* const bytes{ static_cast<char const*>(input) };
+    glz::for_each<N>([&](auto I) {
+      if constexpr (!skipped_member_v<T, I>) {
+        decode_member(member_at<T, I>(value), bytes + offsets[I], byte_swap);
+      }
+    });
+  }
+
+private:
+  template <typename V>
+  static constexpr void encode_member(V const& member, char* output) noexcept {
+    if constexpr (std::same_as<V, bool>) {
+      std::uint32_t const substitute{ member };
+      std::memcpy(output, &substitute, sizeof(substitute));
+    } else if constexpr (fixed_struct<V>) {
+      fixed_layout<V>::encode(member, output);
+    } else {
+      std::memcpy(output, &member, sizeof(V));
+    }
+  }
+
+  template <typename V>
+  static constexpr void decode_member(V& member, char const* input, bool byte_swap) noexcept {
+    if constexpr (std::same_as<V, bool>) {
+      // zero in either byte order
+      std::uint32_t substitute{};
+      std::memcpy(&substitute, input, sizeof(substitute));
+      member = substitute != 0;
+    } else if constexpr (fixed_struct<V>) {
+      fixed_layout<V>::decode(member, input, byte_swap);
+    } else {
+      std::memcpy(&member, input, sizeof(V));
+      if (byte_swap) [[unlikely]] {
+        member = util::byteswap(member);
+      }
+    }
+  }
+};
+
+}  // namespace detail
+
+}  // namespace adbus::protocol
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace adbus::protocol {
+
+/// \brief Output buffer for a scatter/gather write, large string and fixed type array payloads are referenced in place
+/// while the framing in between (lengths, padding, signatures and small values) is copied into an owned buffer.
+/// \note Indexes used by the writer are logical, that is positions in the message as it will appear on the wire.
+/// Referenced payloads must outlive every use of buffers().
+class gather_buffer {
+public:
+  static constexpr auto gathered = true;
+  // Payloads smaller than this are cheaper to copy than to send as a separate segment
+  static constexpr std::size_t default_threshold{ 4096 };
+
+  gather_buffer() = default;
+  explicit gather_buffer(std::size_t threshold) : threshold_{ threshold } {}
+
+  [[nodiscard]] auto threshold() const noexcept -> std::size_t { return threshold_; }
+
+  /// \brief Logical size of the message, owned framing plus referenced payloads
+  [[nodiscard]] auto size() const noexcept -> std::size_t { return framing_.size() + external_size_; }
+
+  void resize(std::size_t size) {
+    // Writes are append only, the logical size can never shrink into a referenced payload
+    framing_.resize(framing_index(size));
+  }
+
+  void clear() noexcept {
+    framing_.clear();
+    segments_.clear();
+    external_size_ = 0;
+  }
+
+  /// \brief Pointer to the owned byte at logical index idx, which must not be inside a referenced payload
+  [[nodiscard]] auto data_at(std::size_t idx) noexcept -> char* { return framing_.data() + framing_index(idx); }
+
+  /// \brief Reference payload at logical index idx, anything written past idx so far is discarded
+  void append_external(std::size_t idx, std::span<const std::byte> payload) {
+    framing_.resize(framing_index(idx));
+    segments_.emplace_back(segment{ .index = idx, .framing_index = framing_.size(), .payload = payload });
+    external_size_ += payload.size();
+  }
+
+  /// \brief The message in wire order, owned framing interleaved with referenced payloads
+  [[nodiscard]] auto buffers() const -> std::vector<std::span<const std::byte>> {
+    std::vector<std::span<const std::byte>> output{};
+    output.reserve(segments_.size() * 2 + 1);
+    const auto framing{ std::as_bytes(std::span{ framing_ }) };
+    std::size_t framing_begin{};
+    for (const auto& seg : segments_) {
+      if (seg.framing_index > framing_begin) {
+        output.emplace_back(framing.subspan(framing_begin, seg.framing_index - framing_begin));
+      }
+      if (!seg.payload.empty()) {
+        output.emplace_back(seg.payload);
+      }
+      framing_begin = seg.framing_index;
+    }
+    if (framing.size() > framing_begin) {
+      output.emplace_back(framing.subspan(framing_begin));
+    }
+    return output;
+  }
+
+  /// \brief Copies the whole message into a contiguous string
+  [[nodiscard]] auto flatten() const -> std::string {
+    std::string output{};
+    output.reserve(size());
+    for (const auto& buffer : buffers()) {
+      output.append(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+    }
+    return output;
+  }
+
+private:
+  struct segment {
+    std::size_t index{};          // logical index of the payload
+    std::size_t framing_index{};  // owned bytes preceding the payload
+    std::span<const std::byte> payload{};
+  };
+
+  [[nodiscard]] auto framing_index(std::size_t idx) const noexcept -> std::size_t {
+    if (segments_.empty() || idx >= segments_.back().index + segments_.back().payload.size()) [[likely]] {
+      return idx - external_size_;
+    }
+    // Back patching an earlier position, such as an array length in front of a referenced payload
+    auto it{ std::ranges::upper_bound(segments_, idx, {}, &segment::index) };
+    if (it == segments_.begin()) {
+      return idx;
+    }
+    --it;
+    if (idx < it->index + it->payload.size()) {
+      return it->framing_index;  // at the start of the payload
+    }
+    return it->framing_index + (idx - it->index - it->payload.size());
+  }
+
+  std::string framing_{};
+  std::vector<segment> segments_{};
+  std::size_t external_size_{};
+  std::size_t threshold_{ default_threshold };
+};
+
+/// \brief A message gathered into buffer along with the params its payloads refer to, both live until the write is done
+/// \note params_t is a reference when made from an lvalue, which must then outlive the message
+template <typename params_t>
+struct outgoing_message {
+  params_t params;
+  gather_buffer buffer{};
+};
+
+/// \brief Shares an outgoing_message which references params if it is an lvalue and moves it in otherwise, params is
+/// never copied
+template <typename params_t>
+[[nodiscard]] auto make_outgoing_message(params_t&& params) -> std::shared_ptr<outgoing_message<params_t>> {
+  return std::make_shared<outgoing_message<params_t>>(std::forward<params_t>(params));
+}
+
+}  // namespace adbus::protocol
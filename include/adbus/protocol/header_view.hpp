@@ -0,0 +1,280 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <expected>
+#include <optional>
+#include <string_view>
+
+#include <adbus/core/context.hpp>
+#include <adbus/protocol/complete_type.hpp>
+#include <adbus/protocol/message_header.hpp>
+
+namespace adbus::protocol::header {
+
+/// \brief Non owning view of a message header, the header fields are indexed by a single scan over the raw bytes.
+/// \note Only the offsets are stored, the accessors read the bytes on demand. The viewed bytes must outlive the view,
+/// rebind it when the bytes are moved, for example when a std::string holding the message is moved.
+class header_view {
+public:
+  // endian, type, flags, version, body length, serial and fields array length
+  static constexpr std::size_t fixed_size{ sizeof(fixed_header) };
+
+  // An empty view, only meant to be assigned to
+  constexpr header_view() noexcept = default;
+
+  /// \brief Indexes the header at the beginning of message, the body does not need to be present
+  [[nodiscard]] static constexpr auto make(std::string_view message) noexcept -> std::expected<header_view, error> {
+    header_view view{ message };
+    if (auto err{ view.index_fields() }) [[unlikely]] {
+      return std::unexpected{ err };
+    }
+    return view;
+  }
+
+  /// \brief Total size of the message which starts at bytes, known once the fixed part of its header is present
+  /// \note Meant for framing a stream of messages, the header is not validated beyond its fixed part
+  [[nodiscard]] static constexpr auto peek_message_size(std::string_view bytes) noexcept -> std::optional<std::size_t> {
+    if (bytes.size() < fixed_size) {
+      return std::nullopt;
+    }
+    return header_view{ bytes }.message_size();
+  }
+
+  /// \brief The same header in another copy of the bytes
+  [[nodiscard]] constexpr auto rebind(std::string_view message) const noexcept -> header_view {
+    header_view view{ *this };
+    view.message_ = message;
+    return view;
+  }
+
+  [[nodiscard]] constexpr auto type() const noexcept -> message_type_e {
+    return static_cast<message_type_e>(message_[type_offset]);
+  }
+  [[nodiscard]] constexpr auto flags() const noexcept -> flags_t {
+    return std::bit_cast<flags_t>(static_cast<std::uint8_t>(message_[flags_offset]));
+  }
+  /// \brief The byte order of the header and the body, read the body in it, e.g. read_dbus_binary(value, body(), order)
+  [[nodiscard]] constexpr auto byte_order() const noexcept -> std::endian {
+    return !message_.empty() && static_cast<char>(message_[0]) == 'B' ? std::endian::big : std::endian::little;
+  }
+  [[nodiscard]] constexpr auto body_length() const noexcept -> std::uint32_t { return read_u32(body_length_offset); }
+  [[nodiscard]] constexpr auto serial() const noexcept -> std::uint32_t { return read_u32(serial_offset); }
+  [[nodiscard]] constexpr auto fields_array_len() const noexcept -> std::uint32_t { return read_u32(fields_array_offset); }
+
+  /// \brief Length of the header including the padding which aligns the body to 8 bytes
+  [[nodiscard]] constexpr auto header_size() const noexcept -> std::size_t {
+    return align8(fixed_size + fields_array_len());
+  }
+  [[nodiscard]] constexpr auto message_size() const noexcept -> std::size_t { return header_size() + body_length(); }
+
+  /// \brief The body, or as much of it as is present in the viewed bytes
+  [[nodiscard]] constexpr auto body() const noexcept -> std::string_view {
+    auto const offset{ header_size() };
+    if (offset >= message_.size()) {
+      return {};
+    }
+    return { message_.data() + offset, std::min<std::size_t>(body_length(), message_.size() - offset) };
+  }
+  /// \brief All of the viewed bytes
+  [[nodiscard]] constexpr auto data() const noexcept -> std::string_view { return message_; }
+
+  [[nodiscard]] constexpr auto path() const noexcept -> std::optional<std::string_view> {
+    return string_field(field_path::code);
+  }
+  [[nodiscard]] constexpr auto interface() const noexcept -> std::optional<std::string_view> {
+    return string_field(field_interface::code);
+  }
+  [[nodiscard]] constexpr auto member() const noexcept -> std::optional<std::string_view> {
+    return string_field(field_member::code);
+  }
+  [[nodiscard]] constexpr auto error_name() const noexcept -> std::optional<std::string_view> {
+    return string_field(field_error_name::code);
+  }
+  [[nodiscard]] constexpr auto reply_serial() const noexcept -> std::optional<std::uint32_t> {
+    return u32_field(field_reply_serial::code);
+  }
+  [[nodiscard]] constexpr auto destination() const noexcept -> std::optional<std::string_view> {
+    return string_field(field_destination::code);
+  }
+  [[nodiscard]] constexpr auto sender() const noexcept -> std::optional<std::string_view> {
+    return string_field(field_sender::code);
+  }
+  [[nodiscard]] constexpr auto signature() const noexcept -> std::optional<std::string_view> {
+    return string_field(field_signature::code);
+  }
+  [[nodiscard]] constexpr auto unix_fds() const noexcept -> std::optional<std::uint32_t> {
+    return u32_field(field_unix_fds::code);
+  }
+
+private:
+  static constexpr std::size_t type_offset{ 1 };
+  static constexpr std::size_t flags_offset{ 2 };
+  static constexpr std::size_t body_length_offset{ 4 };
+  static constexpr std::size_t serial_offset{ 8 };
+  static constexpr std::size_t fields_array_offset{ 12 };
+  static constexpr std::size_t max_field_code{ 9 };
+
+  // Signature of the variant value for each known field code
+  static constexpr std::array<char, max_field_code + 1> field_signatures{ '\0', 'o', 's', 's', 's', 'u', 's', 's', 'g', 'u' };
+
+  struct slot {
+    std::uint32_t offset{};  // zero when the field is absent, the fixed header precedes every field
+    std::uint32_t size{};
+  };
+
+  constexpr explicit header_view(std::string_view message) noexcept : message_{ message } {}
+
+  static constexpr auto align(std::size_t idx, std::size_t alignment) noexcept -> std::size_t {
+    return (idx + alignment - 1) / alignment * alignment;
+  }
+  static constexpr auto align8(std::size_t idx) noexcept -> std::size_t { return align(idx, 8); }
+
+  [[nodiscard]] constexpr auto read_u32(std::size_t idx) const noexcept -> std::uint32_t {
+    std::array<char, sizeof(std::uint32_t)> bytes{};
+    std::copy_n(message_.begin() + static_cast<std::ptrdiff_t>(idx), bytes.size(), bytes.begin());
+    auto const value{ std::bit_cast<std::uint32_t>(bytes) };
+    return byte_order() == std::endian::native ? value : std::byteswap(value);
+  }
+
+  [[nodiscard]] constexpr auto string_field(std::byte code) const noexcept -> std::optional<std::string_view> {
+    const auto& [offset, size]{ fields_[std::to_integer<std::size_t>(code)] };
+    if (offset == 0) {
+      return std::nullopt;
+    }
+    return message_.substr(offset, size);
+  }
+
+  [[nodiscard]] constexpr auto u32_field(std::byte code) const noexcept -> std::optional<std::uint32_t> {
+    const auto& [offset, size]{ fields_[std::to_integer<std::size_t>(code)] };
+    if (offset == 0) {
+      return std::nullopt;
+    }
+    return read_u32(offset);
+  }
+
+  // Validates the framing of every field and records where the value of the known fields is
+  [[nodiscard]] constexpr auto index_fields() noexcept -> error {
+    using enum error_code;
+    if (message_.size() < fixed_size) [[unlikely]] {
+      return error{ .code = out_of_range, .index = message_.size() };
+    }
+    if (static_cast<char>(message_[0]) != 'l' && static_cast<char>(message_[0]) != 'B') [[unlikely]] {
+      return error{ .code = unexpected_enum, .index = 0 };
+    }
+    const std::size_t end{ fixed_size + fields_array_len() };
+    if (end > message_.size()) [[unlikely]] {
+      return error{ .code = out_of_range, .index = message_.size() };
+    }
+    std::size_t idx{ fixed_size };
+    while (idx < end) {
+      // Each field is a struct of a byte code and a variant, structs are 8 byte aligned
+      idx = align8(idx);
+      if (idx + 3 > end) [[unlikely]] {
+        return error{ .code = out_of_range, .index = idx };
+      }
+      const auto code{ static_cast<std::uint8_t>(message_[idx++]) };
+      const auto signature_size{ static_cast<std::uint8_t>(message_[idx++]) };
+      if (idx + signature_size + 1 > end) [[unlikely]] {
+        return error{ .code = out_of_range, .index = idx };
+      }
+      const auto signature{ message_.substr(idx, signature_size) };
+      idx += signature_size + 1;
+      if (code == 0) [[unlikely]] {
+        return error{ .code = unexpected_variant, .index = idx };
+      }
+      if (code > max_field_code) {
+        // Unknown field codes must be accepted and ignored, whatever type their value is of
+        if (signature.empty() || complete_type_size(signature) != signature.size()) [[unlikely]] {
+          return error{ .code = invalid_signature, .index = idx };
+        }
+        detail::value_skipper skipper{ .bytes = message_.substr(0, end),
+                                       .idx = idx,
+                                       .byte_swap = byte_order() != std::endian::native };
+        if (!skipper.skip(signature, 0)) [[unlikely]] {
+          return skipper.err;
+        }
+        idx = skipper.idx;
+        continue;
+      }
+      if (signature.size() != 1 || signature.front() != field_signatures[code]) [[unlikely]] {
+        return error{ .code = unexpected_variant, .index = idx };
+      }
+      slot value{};
+      switch (signature.front()) {
+        case 'y': {
+          value = { static_cast<std::uint32_t>(idx), 1 };
+          break;
+        }
+        case 'n':
+        case 'q': {
+          idx = align(idx, 2);
+          value = { static_cast<std::uint32_t>(idx), 2 };
+          break;
+        }
+        case 'b':
+        case 'i':
+        case 'u':
+        case 'h': {
+          idx = align(idx, 4);
+          value = { static_cast<std::uint32_t>(idx), 4 };
+          break;
+        }
+        case 'x':
+        case 't':
+        case 'd': {
+          idx = align8(idx);
+          value = { static_cast<std::uint32_t>(idx), 8 };
+          break;
+        }
+        case 's':
+        case 'o': {
+          idx = align(idx, 4);
+          if (idx + sizeof(std::uint32_t) > end) [[unlikely]] {
+            return error{ .code = out_of_range, .index = idx };
+          }
+          const auto size{ read_u32(idx) };
+          idx += sizeof(std::uint32_t);
+          value = { static_cast<std::uint32_t>(idx), size };
+          // the null terminator
+          if (idx + size >= end || message_[idx + size] != '\0') [[unlikely]] {
+            return error{ .code = out_of_range, .index = idx };
+          }
+          idx += 1;
+          break;
+        }
+        case 'g': {
+          if (idx + 1 > end) [[unlikely]] {
+            return error{ .code = out_of_range, .index = idx };
+          }
+          const auto size{ static_cast<std::uint8_t>(message_[idx++]) };
+          value = { static_cast<std::uint32_t>(idx), size };
+          if (idx + size >= end || message_[idx + size] != '\0') [[unlikely]] {
+            return error{ .code = out_of_range, .index = idx };
+          }
+          idx += 1;
+          break;
+        }
+        default: {
+          return error{ .code = unexpected_variant, .index = idx };
+        }
+      }
+      idx += value.size;
+      if (idx > end) [[unlikely]] {
+        return error{ .code = out_of_range, .index = idx };
+      }
+      fields_[code] = value;
+    }
+    if (message_.size() < header_size()) [[unlikely]] {
+      return error{ .code = out_of_range, .index = message_.size() };
+    }
+    return {};
+  }
+
+  std::string_view message_{};
+  std::array<slot, max_field_code + 1> fields_{};
+};
+
+}  // namespace adbus::protocol::header
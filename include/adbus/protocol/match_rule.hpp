@@ -0,0 +1,98 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include <adbus/protocol/header_view.hpp>
+
+namespace adbus::protocol {
+
+/// \brief Filter on signals, an empty key matches anything
+/// \note https://dbus.freedesktop.org/doc/dbus-specification.html#message-bus-routing-match-rules
+/// The bus matches sender against well known names as well, locally only the sender field of the message is compared,
+/// which holds the unique name of the connection.
+struct match_rule {
+  std::string sender{};
+  // path and path_namespace are mutually exclusive
+  std::string path{};
+  std::string path_namespace{};
+  std::string interface{};
+  std::string member{};
+  // first argument of the signal, if it is a string
+  std::optional<std::string> arg0{};
+
+  /// \brief The rule in the textual form expected by org.freedesktop.DBus.AddMatch
+  [[nodiscard]] auto to_string() const -> std::string {
+    std::string output{ "type='signal'" };
+    auto append{ [&output](std::string_view key, std::string_view value) {
+      output += ',';
+      output += key;
+      output += "='";
+      for (auto const character : value) {
+        if (character == '\'') {
+          // a quote is written outside of the quoted value, escaped by a backslash
+          output += R"('\'')";
+        } else {
+          output += character;
+        }
+      }
+      output += '\'';
+    } };
+    for (auto const& [key, value] : { std::pair<std::string_view, std::string_view>{ "sender", sender },
+                                      { "path", path },
+                                      { "path_namespace", path_namespace },
+                                      { "interface", interface },
+                                      { "member", member } }) {
+      if (!value.empty()) {
+        append(key, value);
+      }
+    }
+    if (arg0) {
+      // an empty arg0 is a valid filter
+      append("arg0", *arg0);
+    }
+    return output;
+  }
+
+  /// \brief Whether the signal matches this rule
+  /// \param signal_arg0 first argument of the signal if it is a string
+  [[nodiscard]] auto matches(header::header_view const& signal,
+                             std::optional<std::string_view> signal_arg0) const noexcept -> bool {
+    if (signal.type() != header::message_type_e::signal) {
+      return false;
+    }
+    if (!sender.empty() && signal.sender() != sender) {
+      return false;
+    }
+    if (!interface.empty() && signal.interface() != interface) {
+      return false;
+    }
+    if (!member.empty() && signal.member() != member) {
+      return false;
+    }
+    if (!path.empty() && signal.path() != path) {
+      return false;
+    }
+    if (!path_namespace.empty() && !in_namespace(signal.path().value_or(""), path_namespace)) {
+      return false;
+    }
+    if (arg0 && signal_arg0 != *arg0) {
+      return false;
+    }
+    return true;
+  }
+
+  /// \brief Whether object_path is path_namespace or below it
+  [[nodiscard]] static constexpr auto in_namespace(std::string_view object_path,
+                                                   std::string_view path_namespace) noexcept -> bool {
+    if (path_namespace == "/") {
+      return object_path.starts_with('/');
+    }
+    return object_path.starts_with(path_namespace) &&
+           (object_path.size() == path_namespace.size() || object_path[path_namespace.size()] == '/');
+  }
+};
+
+}  // namespace adbus::protocol
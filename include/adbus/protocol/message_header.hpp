@@ -1,13 +1,21 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <bit>
 #include <bitset>
+#include <cstddef>
+#include <memory_resource>
+#include <string_view>
+#include <type_traits>
+#include <utility>
 #include <variant>
 #include <vector>
 
 #include <fmt/format.h>
 #include <glaze/core/common.hpp>
 
+#include <adbus/protocol/complete_type.hpp>
 #include <adbus/protocol/name.hpp>
 #include <adbus/protocol/path.hpp>
 #include <adbus/protocol/signature.hpp>
@@ -190,7 +198,8 @@ using field_destination = header_field<std::byte{ 6 }, bus_name>;
 // other servers may define their own meanings for it. On a message bus, this header field is controlled by the message bus,
 // so it is as reliable and trustworthy as the message bus itself. Otherwise, this header field is controlled by the message
 // sender, unless there is out-of-band information that indicates otherwise.
-using field_sender = header_field<std::byte{ 7 }, std::string>;
+// Held in a std::pmr::string as path and the names, so every field of a header decoded into an arena lives in it.
+using field_sender = header_field<std::byte{ 7 }, std::pmr::string>;
 // The signature of the message body. If omitted, it is assumed to be the empty signature "" (i.e. the body must be
 // 0-length). This header field is controlled by the message sender.
 using field_signature = header_field<std::byte{ 8 }, type::signature>;
@@ -253,8 +262,9 @@ struct header {
   // must not be zero.
   std::uint32_t serial{ 0 };
   // An array of zero or more header fields where the byte is the field code, and the variant is the field value. The message
-  // type determines which fields are required.
-  std::vector<field> fields{};
+  // type determines which fields are required. Decoding allocates the fields and their strings from the resource of this
+  // vector, e.g. header{ .fields = std::pmr::vector<field>{ &arena } }
+  std::pmr::vector<field> fields{};
 
   std::optional<std::uint32_t> reply_serial() const noexcept {
     for (auto&& f : fields) {
@@ -286,7 +296,7 @@ constexpr auto format_as(header const& h) noexcept -> std::string {
 }
 
 struct fixed_header {
-  const std::byte endian{ details::serialize_endian() };
+  std::byte endian{ details::serialize_endian() };
   message_type_e type{ message_type_e::invalid };
   flags_t flags{};
   std::byte version{ 1 };
@@ -339,7 +349,12 @@ struct glz::meta<adbus::protocol::header::fixed_header> {
       "type",
       &T::type,
       "flags",
-      [](auto&& self) -> auto& { return *reinterpret_cast<const std::uint8_t*>(&self.flags); },
+      [](auto&& self) -> auto& {
+        // writable when self is, so the header can be read in place
+        using byte_t = std::conditional_t<std::is_const_v<std::remove_reference_t<decltype(self)>>, const std::uint8_t,
+                                          std::uint8_t>;
+        return *reinterpret_cast<byte_t*>(&self.flags);
+      },
       "version",
       &T::version,
       "body_length",
@@ -356,69 +371,126 @@ struct from_dbus_binary;
 
 template <>
 struct from_dbus_binary<header::field> {
+  using variant_t = header::field::variant_t;
+  static constexpr auto N = std::variant_size_v<variant_t>;
+
+  // Field codes are small and dense, the code indexes the tables below directly
+  static constexpr std::size_t max_code = [] {
+    std::size_t output{};
+    glz::for_each<N>([&](auto I) {
+      output = std::max(output, std::to_integer<std::size_t>(std::variant_alternative_t<I, variant_t>::code));
+    });
+    return output;
+  }();
+
+  // The alternative of each field code, N for codes which are not known
+  static constexpr auto alternatives = [] {
+    std::array<std::size_t, max_code + 1> output{};
+    output.fill(N);
+    glz::for_each<N>([&](auto I) {
+      output[std::to_integer<std::size_t>(std::variant_alternative_t<I, variant_t>::code)] = I;
+    });
+    return output;
+  }();
+  static_assert(static_cast<std::size_t>(std::ranges::count(alternatives, N)) == alternatives.size() - N,
+                "header field codes must be unique");
+
+  // The single character signature of each known field code
+  static constexpr auto signatures = [] {
+    std::array<char, max_code + 1> output{};
+    glz::for_each<N>([&](auto I) {
+      using field_type = std::variant_alternative_t<I, variant_t>;
+      static_assert(type::signature_v<field_type>.size() == 1, "a header field must hold a single basic type");
+      output[std::to_integer<std::size_t>(field_type::code)] = type::signature_v<field_type>.front();
+    });
+    return output;
+  }();
+
+  /// \brief Unknown field codes must be accepted and ignored, read_elements drops such fields from the array
+  static constexpr auto ignored(header::field const& value) noexcept -> bool {
+    auto const code{ std::to_integer<std::size_t>(value.code) };
+    return code > max_code || alternatives[code] == N;
+  }
+
   template <options Opts>
   static constexpr void op(auto&& value, is_context auto&& ctx, auto&& begin, auto&& it, auto&& end) noexcept {
     // A struct must start on an 8-byte boundary regardless of the type of the struct fields.
     detail::skip_padding<std::uint64_t>(ctx, begin, it, end);
+    if (ctx.err) [[unlikely]] {
+      return;
+    }
     from_dbus_binary<decltype(value.code)>::template op<Opts>(value.code, ctx, begin, it, end);
     if (ctx.err) [[unlikely]] {
       return;
     }
-    namespace header = adbus::protocol::header;
-    auto const extract_variant{ [&]<typename field_type>(field_type&&) {
-      type::signature read_signature{};
-      from_dbus_binary<type::signature>::template op<Opts>(read_signature, ctx, begin, it, end);
-      if (ctx.err) [[unlikely]] {
-        return;
-      }
-      if (read_signature != type::signature_v<field_type>) [[unlikely]] {
-        ctx.err = { .code = error_code::unexpected_variant, .index = static_cast<error::index_t>(std::distance(begin, it)) };
-        return;
-      }
-      value.value.template emplace<field_type>();
-      from_dbus_binary<decltype(field_type{}.value)>::template op<Opts>(std::get<field_type>(value.value).value, ctx, begin, it, end);
-    } };
-    switch (value.code) {
-      case header::field_path::code: {
-        extract_variant(header::field_path{});
-        return;
-      }
-      case header::field_interface::code: {
-        extract_variant(header::field_interface{});
-        return;
-      }
-      case header::field_member::code: {
-        extract_variant(header::field_member{});
-        return;
-      }
-      case header::field_error_name::code: {
-        extract_variant(header::field_error_name{});
-        return;
-      }
-      case header::field_reply_serial::code: {
-        extract_variant(header::field_reply_serial{});
-        return;
-      }
-      case header::field_destination::code: {
-        extract_variant(header::field_destination{});
-        return;
-      }
-      case header::field_sender::code: {
-        extract_variant(header::field_sender{});
-        return;
-      }
-      case header::field_signature::code: {
-        extract_variant(header::field_signature{});
-        return;
-      }
-      case header::field_unix_fds::code: {
-        extract_variant(header::field_unix_fds{});
-        return;
-      }
-      default:
-        ctx.err = { .code = error_code::unexpected_variant, .index = static_cast<error::index_t>(std::distance(begin, it)) };
-        return;
+    // The signature is compared in place: its length, the type codes and the null terminator
+    if (it == end) [[unlikely]] {
+      ctx.err = { .code = error_code::out_of_range, .index = static_cast<error::index_t>(std::distance(begin, it)) };
+      return;
+    }
+    auto const signature_size{ static_cast<std::uint8_t>(*it) };
+    if (std::distance(it, end) < signature_size + 2) [[unlikely]] {
+      ctx.err = { .code = error_code::out_of_range, .index = static_cast<error::index_t>(std::distance(begin, it)) };
+      return;
+    }
+    std::string_view const signature{ reinterpret_cast<char const*>(&*std::next(it)), signature_size };
+    if (static_cast<char>(*std::next(it, signature_size + 1)) != '\0') [[unlikely]] {
+      ctx.err = { .code = error_code::unexpected_variant, .index = static_cast<error::index_t>(std::distance(begin, it)) };
+      return;
+    }
+    std::advance(it, signature_size + 2);
+
+    auto const code{ std::to_integer<std::size_t>(value.code) };
+    if (code == 0) [[unlikely]] {
+      // INVALID, not a valid field name
+      ctx.err = { .code = error_code::unexpected_variant, .index = static_cast<error::index_t>(std::distance(begin, it)) };
+      return;
+    }
+    if (ignored(value)) {
+      skip_value(signature, ctx, begin, it, end);
+      return;
+    }
+    if (signature.size() != 1 || signature.front() != signatures[code]) [[unlikely]] {
+      ctx.err = { .code = error_code::unexpected_variant, .index = static_cast<error::index_t>(std::distance(begin, it)) };
+      return;
+    }
+
+    using reader_t = void (*)(header::field&, std::remove_reference_t<decltype(ctx)>&,
+                              std::remove_reference_t<decltype(begin)>&, std::remove_reference_t<decltype(it)>&,
+                              std::remove_reference_t<decltype(end)>&) noexcept;
+    static constexpr auto readers = []<std::size_t... I>(std::index_sequence<I...>) {
+      return std::array<reader_t, N>{ &read_field<I, Opts, std::remove_reference_t<decltype(ctx)>,
+                                                  std::remove_reference_t<decltype(begin)>,
+                                                  std::remove_reference_t<decltype(it)>,
+                                                  std::remove_reference_t<decltype(end)>>... };
+    }(std::make_index_sequence<N>{});
+    readers[alternatives[code]](value, ctx, begin, it, end);
+  }
+
+private:
+  template <std::size_t I, options Opts, typename ctx_t, typename... args_t>
+  static constexpr void read_field(header::field& value, ctx_t& ctx, args_t&... args) noexcept {
+    using field_type = std::variant_alternative_t<I, variant_t>;
+    value.value.template emplace<I>(make_element<field_type>(ctx));
+    from_dbus_binary<typename field_type::type>::template op<Opts>(std::get<I>(value.value).value, ctx, args...);
+  }
+
+  // Skips the value of an unknown field, which may be of any complete type, e.g. a{sv}
+  static constexpr void skip_value(std::string_view signature, auto& ctx, auto& begin, auto& it, auto& end) noexcept {
+    if (signature.empty() || complete_type_size(signature) != signature.size()) [[unlikely]] {
+      ctx.err = { .code = error_code::invalid_signature, .index = static_cast<error::index_t>(std::distance(begin, it)) };
+      return;
+    }
+    // alignment is relative to begin, as it is for every other value read
+    value_skipper skipper{ .bytes = { reinterpret_cast<char const*>(&*begin),
+                                      static_cast<std::size_t>(std::distance(begin, end)) },
+                           .idx = static_cast<std::size_t>(std::distance(begin, it)),
+                           .byte_swap = ctx.byte_swap };
+    if (!skipper.skip(signature, 0)) [[unlikely]] {
+      ctx.err = skipper.err;
+      return;
     }
+    std::advance(it, skipper.idx - static_cast<std::size_t>(std::distance(begin, it)));
   }
 };
 
@@ -50,5 +50,55 @@ auto request_name() -> protocol::header::header {
   };
 }
 
+auto add_match() -> protocol::header::header {
+  using namespace adbus::protocol::header;
+  using std::string_view_literals::operator""sv;
+  return {
+        .type = message_type_e::method_call,
+        .fields = {
+          {
+                field_destination{"org.freedesktop.DBus"}
+          },
+          {
+                field_path{"/org/freedesktop/DBus"}
+          },
+          {
+                field_interface{"org.freedesktop.DBus"}
+          },
+          {
+                field_member{"AddMatch"}
+          },
+          {
+                field_signature{"s"sv}
+          }
+        },
+  };
+}
+
+auto remove_match() -> protocol::header::header {
+  using namespace adbus::protocol::header;
+  using std::string_view_literals::operator""sv;
+  return {
+        .type = message_type_e::method_call,
+        .fields = {
+          {
+                field_destination{"org.freedesktop.DBus"}
+          },
+          {
+                field_path{"/org/freedesktop/DBus"}
+          },
+          {
+                field_interface{"org.freedesktop.DBus"}
+          },
+          {
+                field_member{"RemoveMatch"}
+          },
+          {
+                field_signature{"s"sv}
+          }
+        },
+  };
+}
+
 }
 
@@ -2,11 +2,13 @@
 
 #include <cstdint>
 #include <expected>
+#include <memory_resource>
 #include <string>
 #include <string_view>
 #include <system_error>
 
 #include <adbus/core/context.hpp>
+#include <adbus/protocol/char_scan.hpp>
 
 namespace adbus::protocol {
 
@@ -21,19 +23,19 @@ struct name {
     if (input.size() > max_length) {
       return error{ .code = error_code::too_long, .index = input.size() };
     }
-    auto err{ explicit_name_t::validate_inner(input) };
-    if (err) {
-      return err;
+    if (!explicit_name_t::valid_first(input.front())) {
+      return error{ .code = error_code::invalid_character, .index = 0 };
+    }
+    // a single pass over the rest for the characters and the doubled dots
+    auto const found{ detail::scan_chars<'.', explicit_name_t::dot_separated>(input, 1) };
+    if (found.invalid != detail::char_scan::npos) {
+      return error{ .code = error_code::invalid_character, .index = found.invalid };
     }
     if (input.back() == '.') {
       return error{ .code = error_code::trailing_dot, .index = input.size() - 1 };
     }
-    for (auto it = input.begin() + 1; it != input.end(); ++it) {
-      // We have already checked the first character so this should be safe.
-      if (*it == '.' && *(it - 1) == '.') {
-        return error{ .code = error_code::multiple_dots,
-                      .index = static_cast<error::index_t>(std::distance(input.begin(), it)) };
-      }
+    if (found.doubled != detail::char_scan::npos) {
+      return error{ .code = error_code::multiple_dots, .index = found.doubled };
     }
     return error{};
   }
@@ -43,11 +45,13 @@ struct name {
     if (err) {
       return std::unexpected{ err };
     }
-    return explicit_name_t{ std::string{ input } };
+    return explicit_name_t{ std::pmr::string{ input } };
   }
 
   constexpr auto operator==(name const& other) const -> bool = default;
-  std::string value{};
+  // A std::pmr::string so a decoded name allocates from the resource of the read, std::string{ n.value } for a copy owned
+  // by the default allocator
+  std::pmr::string value{};
 };
 
 template <typename explicit_name_t>
@@ -60,20 +64,9 @@ struct interface_name : name<interface_name> {
   // least one character.
   // - Each element must only contain the ASCII characters "[A-Z][a-z][0-9]_" and must not begin with a digit.
   // - Interface names must not exceed the maximum name length.
-  static constexpr error validate_inner(std::string_view input) noexcept {
-    auto const beginning_letter{ *input.begin() };
-    if (!((beginning_letter >= 'A' && beginning_letter <= 'Z') || (beginning_letter >= 'a' && beginning_letter <= 'z') ||
-          beginning_letter == '_')) {
-      return error{ .code = error_code::invalid_character, .index = 0 };
-    }
-    for (auto it = input.begin() + 1; it != input.end(); ++it) {
-      if (!((*it >= 'A' && *it <= 'Z') || (*it >= 'a' && *it <= 'z') || (*it >= '0' && *it <= '9') || *it == '_' ||
-            *it == '.')) {
-        return error{ .code = error_code::invalid_character,
-                      .index = static_cast<error::index_t>(std::distance(input.begin(), it)) };
-      }
-    }
-    return error{};
+  static constexpr bool dot_separated{ true };
+  static constexpr auto valid_first(char c) noexcept -> bool {
+    return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || c == '_';
   }
 };
 
@@ -88,20 +81,9 @@ struct bus_name : name<bus_name> {
   // - Bus names must contain at least one '.' (period) character (and thus at least two elements).
   // - Bus names must not begin with a '.' (period) character.
   // - Bus names must not exceed the maximum name length.
-  static constexpr error validate_inner(std::string_view input) noexcept {
-    auto const beginning_letter{ *input.begin() };
-    if (!((beginning_letter >= 'A' && beginning_letter <= 'Z') || (beginning_letter >= 'a' && beginning_letter <= 'z') ||
-          beginning_letter == '_' || beginning_letter == ':')) {
-      return error{ .code = error_code::invalid_character, .index = 0 };
-    }
-    for (auto it = input.begin() + 1; it != input.end(); ++it) {
-      if (!((*it >= 'A' && *it <= 'Z') || (*it >= 'a' && *it <= 'z') || (*it >= '0' && *it <= '9') || *it == '_' ||
-            *it == '.')) {
-        return error{ .code = error_code::invalid_character,
-                      .index = static_cast<error::index_t>(std::distance(input.begin(), it)) };
-      }
-    }
-    return error{};
+  static constexpr bool dot_separated{ true };
+  static constexpr auto valid_first(char c) noexcept -> bool {
+    return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || c == '_' || c == ':';
   }
 };
 
@@ -110,19 +92,9 @@ struct member_name : name<member_name> {
   // - Must not contain the '.' (period) character.
   // - Must not exceed the maximum name length.
   // - Must be at least 1 byte in length.
-  static constexpr error validate_inner(std::string_view input) noexcept {
-    auto const beginning_letter{ *input.begin() };
-    if (!((beginning_letter >= 'A' && beginning_letter <= 'Z') || (beginning_letter >= 'a' && beginning_letter <= 'z') ||
-          beginning_letter == '_')) {
-      return error{ .code = error_code::invalid_character, .index = 0 };
-    }
-    for (auto it = input.begin() + 1; it != input.end(); ++it) {
-      if (!((*it >= 'A' && *it <= 'Z') || (*it >= 'a' && *it <= 'z') || (*it >= '0' && *it <= '9') || *it == '_')) {
-        return error{ .code = error_code::invalid_character,
-                      .index = static_cast<error::index_t>(std::distance(input.begin(), it)) };
-      }
-    }
-    return error{};
+  static constexpr bool dot_separated{ false };
+  static constexpr auto valid_first(char c) noexcept -> bool {
+    return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || c == '_';
   }
 };
 
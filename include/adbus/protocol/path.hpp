@@ -1,10 +1,12 @@
 #pragma once
 
 #include <expected>
+#include <memory_resource>
 #include <string>
 #include <string_view>
 
 #include <adbus/core/context.hpp>
+#include <adbus/protocol/char_scan.hpp>
 
 namespace adbus::protocol {
 
@@ -30,15 +32,13 @@ struct path {
     if (input.back() == '/') {
       return error{ .code = trailing_slash, .index = input.size() - 1 };
     }
-    for (auto it = input.begin() + 1; it != input.end(); ++it) {
-      if (*it == '/' && *(it - 1) == '/') {
-        return error{ .code = multiple_slashes, .index = static_cast<error::index_t>(std::distance(input.begin(), it)) };
-      }
-      // We have already checked the first character so this should be safe.
-      if (!((*it >= 'A' && *it <= 'Z') || (*it >= 'a' && *it <= 'z') || (*it >= '0' && *it <= '9') || *it == '_' ||
-            *it == '/')) {
-        return error{ .code = invalid_character, .index = static_cast<error::index_t>(std::distance(input.begin(), it)) };
-      }
+    // We have already checked the first character, whichever of the two problems comes first is reported
+    auto const found{ detail::scan_chars<'/', true>(input, 1) };
+    if (found.doubled < found.invalid) {
+      return error{ .code = multiple_slashes, .index = found.doubled };
+    }
+    if (found.invalid != detail::char_scan::npos) {
+      return error{ .code = invalid_character, .index = found.invalid };
     }
     // todo length check?
     return error{};
@@ -49,10 +49,12 @@ struct path {
     if (err) {
       return std::unexpected{ err };
     }
-    return path{ .buffer = std::string{ input } };
+    return path{ .buffer = std::pmr::string{ input } };
   }
   constexpr auto operator==(path const& other) const -> bool = default;
-  std::string buffer{};
+  // A std::pmr::string so a decoded path allocates from the resource of the read, std::string{ p.buffer } for a copy owned
+  // by the default allocator
+  std::pmr::string buffer{};
 };
 
 constexpr auto format_as(path const& p) -> std::string_view {
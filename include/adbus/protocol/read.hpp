@@ -1,12 +1,27 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <memory_resource>
+#include <span>
+#include <string_view>
+#include <utility>
+#include <variant>
+
 #include <glaze/concepts/container_concepts.hpp>
 #include <glaze/core/reflection_tuple.hpp>
 #include <glaze/util/expected.hpp>
 
 #include <adbus/core/context.hpp>
+#include <adbus/protocol/fixed_layout.hpp>
 #include <adbus/protocol/padding.hpp>
 #include <adbus/protocol/signature.hpp>
+#include <adbus/util/byteswap.hpp>
 #include <adbus/util/concepts.hpp>
 
 namespace adbus::protocol {
@@ -29,9 +44,36 @@ constexpr void skip_padding(auto&& ctx, auto&& begin, auto&& it, auto&& end) noe
   std::advance(it, padding);
 }
 
+// A value to read into, allocator aware types and wrappers around them take their memory from the context resource
+template <typename T>
+constexpr auto make_element(is_context auto&& ctx) -> T {
+  if constexpr (std::uses_allocator_v<T, std::pmr::polymorphic_allocator<>>) {
+    return std::make_obj_using_allocator<T>(std::pmr::polymorphic_allocator<>{ ctx.resource });
+  } else if constexpr (is_header<T> && std::uses_allocator_v<decltype(T::fields), std::pmr::polymorphic_allocator<>>) {
+    return T{ .fields = decltype(T::fields)(std::pmr::polymorphic_allocator<>{ ctx.resource }) };
+  } else if constexpr (glz::detail::glaze_value_t<T>) {
+    // e.g. path or a header field, the wrapped member must be constructed with the allocator as assignment would not
+    // propagate it
+    using V = std::decay_t<decltype(glz::detail::get_member(std::declval<T&>(), glz::meta_wrapper_v<T>))>;
+    if constexpr (std::uses_allocator_v<V, std::pmr::polymorphic_allocator<>> || glz::detail::glaze_value_t<V>) {
+      return T{ make_element<V>(ctx) };
+    } else {
+      return T{};
+    }
+  } else {
+    return T{};
+  }
+}
+
 template <typename T>
 struct from_dbus_binary;
 
+// Elements of an array which the specification requires to be accepted and dropped, e.g. header fields of unknown codes
+template <typename T>
+concept ignorable_element = requires(T const& element) {
+  { from_dbus_binary<T>::ignored(element) } -> std::same_as<bool>;
+};
+
 template <num_t T>
 struct from_dbus_binary<T> {
   template <options Opts>
@@ -47,6 +89,12 @@ struct from_dbus_binary<T> {
     }
     // todo remove this casts
     std::memcpy(reinterpret_cast<void*>(const_cast<V*>(&value)), &*it, sizeof(V));
+    if constexpr (sizeof(V) > 1) {
+      if (ctx.byte_swap) [[unlikely]] {
+        auto& non_const_value = const_cast<V&>(value);
+        non_const_value = util::byteswap(non_const_value);
+      }
+    }
     std::advance(it, sizeof(V));
   }
 };
@@ -114,8 +162,7 @@ struct from_dbus_binary<T> {
       ctx.err = error{ error_code::out_of_range, static_cast<std::size_t>(std::distance(begin, it)) };
       return;
     }
-    std::memcpy(value.data(), &*it, size);
-    value.size_ = size;          // todo could we do this differently?
+    value.assign(std::string_view{ reinterpret_cast<char const*>(&*it), size });
     std::advance(it, size + 1);  // the +1 is for the null terminator
   }
 };
@@ -159,19 +206,91 @@ struct from_dbus_binary<T> {
       return;
     }
     using V = std::decay_t<decltype(value)>;
+    if constexpr (adbus::type::contiguous_fixed<V>) {
+      read_contiguous(value, n, ctx, begin, it);
+    } else {
+      read_elements<Opts>(value, n, ctx, begin, it, end);
+    }
+  }
+
+private:
+  // The array data has the same representation as the elements in memory, so the element count follows from n
+  static constexpr void read_contiguous(auto&& value,
+                                        std::uint32_t n,
+                                        is_context auto&& ctx,
+                                        auto&& begin,
+                                        auto&& it) noexcept {
+    using V = std::decay_t<decltype(value)>;
+    using element_t = std::ranges::range_value_t<V>;
+    if (n % sizeof(element_t) != 0) [[unlikely]] {
+      ctx.err = error{ error_code::out_of_range, static_cast<std::size_t>(std::distance(begin, it)) };
+      return;
+    }
+    const std::size_t count{ n / sizeof(element_t) };
+    if constexpr (is_span<V>) {
+      static_assert(std::is_const_v<typename V::element_type>,
+                    "A view into the buffer being read must be std::span<const T>");
+      if (count == 0) {
+        value = V{};
+        return;
+      }
+      // zero copy, the view refers directly into the buffer so it is only valid as long as the buffer is
+      if (reinterpret_cast<std::uintptr_t>(&*it) % alignof(element_t) != 0) [[unlikely]] {
+        ctx.err = error{ error_code::unaligned, static_cast<std::size_t>(std::distance(begin, it)) };
+        return;
+      }
+      if (sizeof(element_t) > 1 && ctx.byte_swap) [[unlikely]] {
+        ctx.err = error{ error_code::foreign_byte_order, static_cast<std::size_t>(std::distance(begin, it)) };
+        return;
+      }
+      value = V{ reinterpret_cast<typename V::element_type*>(&*it), count };
+    } else {
+      if constexpr (glz::resizable<V>) {
+        value.resize(count);
+      } else if (count > std::ranges::size(value)) [[unlikely]] {
+        ctx.err = error{ error_code::out_of_range, static_cast<std::size_t>(std::distance(begin, it)) };
+        return;
+      }
+      if constexpr (sizeof(element_t) > 1) {
+        if (ctx.byte_swap) [[unlikely]] {
+          util::byteswap_copy<sizeof(element_t)>(std::ranges::data(value), &*it, count);
+          std::advance(it, n);
+          return;
+        }
+      }
+      if (n > 0) {
+        std::memcpy(std::ranges::data(value), &*it, n);
+      }
+    }
+    std::advance(it, n);
+  }
+
+  template <options Opts>
+  static constexpr void read_elements(auto&& value,
+                                      std::uint32_t n,
+                                      is_context auto&& ctx,
+                                      auto&& begin,
+                                      auto&& it,
+                                      auto&& end) noexcept {
+    using V = std::decay_t<decltype(value)>;
     if constexpr (has_clear<V>) {
       value.clear();
     }
     std::size_t idx{};
     std::int64_t n_signed{ n };
     while (n_signed > 0) {
-      typename V::value_type element{};
+      auto element{ make_element<typename V::value_type>(ctx) };
       auto const beginning_of_element = it;
       from_dbus_binary<typename V::value_type>::template op<Opts>(element, ctx, begin, it, end);
       if (ctx.err) [[unlikely]] {
         return;
       }
       n_signed -= std::distance(beginning_of_element, it);
+      if constexpr (ignorable_element<typename V::value_type>) {
+        if (from_dbus_binary<typename V::value_type>::ignored(element)) {
+          continue;
+        }
+      }
       if constexpr (glz::detail::emplace_backable<V>) {
         value.emplace_back(std::move(element));
       } else if constexpr (array_like<V>) {
@@ -215,26 +334,72 @@ template <glz::is_variant T>
 struct from_dbus_binary<T> {
   static constexpr auto N = std::variant_size_v<T>;
 
+  static constexpr auto signatures = []<std::size_t... I>(std::index_sequence<I...>) {
+    return std::array<std::string_view, N>{ type::signature_v<std::decay_t<std::variant_alternative_t<I, T>>>... };
+  }(std::make_index_sequence<N>{});
+
+  // Alternatives ordered by the first character of their signature, the alternatives whose signature starts with c are
+  // by_first[first_begin[c]] up to by_first[first_begin[c + 1]], usually a single one
+  static constexpr auto by_first = [] {
+    std::array<std::size_t, N> output{};
+    for (std::size_t idx{}; idx < N; ++idx) {
+      output[idx] = idx;
+    }
+    std::ranges::sort(output, {}, [](std::size_t idx) {
+      return std::pair{ static_cast<unsigned char>(signatures[idx][0]), idx };
+    });
+    return output;
+  }();
+  static constexpr auto first_begin = [] {
+    std::array<std::size_t, 257> output{};
+    for (auto const& signature : signatures) {
+      ++output[static_cast<unsigned char>(signature[0]) + 1];
+    }
+    for (std::size_t idx{ 1 }; idx < output.size(); ++idx) {
+      output[idx] += output[idx - 1];
+    }
+    return output;
+  }();
+
+  template <std::size_t I, options Opts, typename ctx_t, typename... args_t>
+  static constexpr void read_alternative(T& variant, ctx_t& ctx, args_t&... args) noexcept {
+    using V = std::decay_t<std::variant_alternative_t<I, T>>;
+    variant.template emplace<I>(make_element<V>(ctx));
+    from_dbus_binary<V>::template op<Opts>(std::get<I>(variant), ctx, args...);
+  }
+
   template <options Opts>
-  static constexpr void op(auto&& variant, is_context auto&& ctx, auto&&... args) noexcept {
-    type::signature read_signature{};
-    from_dbus_binary<type::signature>::template op<Opts>(read_signature, ctx, args...);
+  static constexpr void op(auto&& variant, is_context auto&& ctx, auto&& begin, auto&& it, auto&& end) noexcept {
+    // the signature is compared where it is in the buffer
+    std::uint8_t size{};
+    from_dbus_binary<decltype(size)>::template op<Opts>(size, ctx, begin, it, end);
     if (ctx.err) [[unlikely]] {
       return;
     }
-    bool found_it{};
-    glz::for_each<N>([&](auto I) {
-      using V = std::decay_t<std::variant_alternative_t<I, T>>;
-      // todo how to exit early? probably not possible during run time
-      if (!found_it && read_signature == type::signature_v<V>) {
-        variant.template emplace<I>();
-        from_dbus_binary<V>::template op<Opts>(std::get<I>(variant), ctx, args...);
-        found_it = true;
+    if (it + size + 1 > end) [[unlikely]] {
+      ctx.err = error{ error_code::out_of_range, static_cast<std::size_t>(std::distance(begin, it)) };
+      return;
+    }
+    std::string_view const read_signature{ reinterpret_cast<char const*>(&*it), size };
+    std::advance(it, size + 1);  // the +1 is for the null terminator
+
+    using reader_t = void (*)(T&, std::remove_reference_t<decltype(ctx)>&, std::remove_reference_t<decltype(begin)>&,
+                              std::remove_reference_t<decltype(it)>&, std::remove_reference_t<decltype(end)>&) noexcept;
+    static constexpr auto readers = []<std::size_t... I>(std::index_sequence<I...>) {
+      return std::array<reader_t, N>{ &read_alternative<I, Opts, std::remove_reference_t<decltype(ctx)>,
+                                                        std::remove_reference_t<decltype(begin)>,
+                                                        std::remove_reference_t<decltype(it)>,
+                                                        std::remove_reference_t<decltype(end)>>... };
+    }(std::make_index_sequence<N>{});
+
+    auto const first{ read_signature.empty() ? std::size_t{} : static_cast<unsigned char>(read_signature[0]) };
+    for (auto pos{ first_begin[first] }; pos < first_begin[first + 1]; ++pos) {
+      if (signatures[by_first[pos]] == read_signature) [[likely]] {
+        readers[by_first[pos]](variant, ctx, begin, it, end);
+        return;
       }
-    });
-    if (!found_it) [[unlikely]] {
-      ctx.err = error{ error_code::unexpected_variant };
     }
+    ctx.err = error{ error_code::unexpected_variant, static_cast<std::size_t>(std::distance(begin, it)) };
   }
 };
 
@@ -250,31 +415,59 @@ struct from_dbus_binary<T> {
     if (ctx.err) [[unlikely]] {
       return;
     }
-    decltype(auto) t = glz::detail::reflection_tuple<T>(value);
-    glz::for_each<N>([&](auto I) {
-      using Element = glz::detail::glaze_tuple_element<I, N, T>;
-      static constexpr size_t member_index = Element::member_index;
-      using val_t = std::remove_cvref_t<typename Element::type>;
-      if constexpr (std::same_as<val_t, glz::hidden> || std::same_as<val_t, glz::skip>) {
+    if constexpr (is_header<T>) {
+      // Both header and body are in the byte order of the endian flag, the first byte of the header
+      if (it == end) [[unlikely]] {
+        ctx.err = error{ error_code::out_of_range, static_cast<std::size_t>(std::distance(begin, it)) };
         return;
-      } else {
-        decltype(auto) member = [&]() -> decltype(auto) {
-          if constexpr (glz::detail::reflectable<T>) {
-            return std::get<I>(t);
-          } else {
-            return glz::get<member_index>(glz::get<I>(glz::meta_v<std::decay_t<T>>));
-          }
-        }();
-        auto& member_ref = glz::detail::get_member(value, member);
-        from_dbus_binary<std::decay_t<decltype(member_ref)>>::template op<Opts>(member_ref, ctx, begin, it, end);
       }
-    });
-    if constexpr (is_header<T>) {
-      // todo test
-      // The length of the header must be a multiple of 8, allowing the body to begin on an 8-byte boundary when storing the
-      // entire message in a single buffer. If the header does not naturally end on an 8-byte boundary up to 7 bytes of
-      // nul-initialized alignment padding must be added.
-      skip_padding<std::uint64_t>(ctx, begin, it, end);
+      switch (static_cast<char>(*it)) {
+        case 'l':
+          ctx.byte_swap = std::endian::native != std::endian::little;
+          break;
+        case 'B':
+          ctx.byte_swap = std::endian::native != std::endian::big;
+          break;
+        default:
+          ctx.err = error{ error_code::unexpected_enum, static_cast<std::size_t>(std::distance(begin, it)) };
+          return;
+      }
+    }
+    if constexpr (fixed_struct<T>) {
+      // A single bounds check, every member is read from its known offset
+      if (it + fixed_layout<T>::size > end) [[unlikely]] {
+        ctx.err = error{ error_code::out_of_range, static_cast<std::size_t>(std::distance(begin, it)) };
+        return;
+      }
+      fixed_layout<T>::decode(value, &*it, ctx.byte_swap);
+      std::advance(it, fixed_layout<T>::size);
+    } else {
+      decltype(auto) t = glz::detail::reflection_tuple<T>(value);
+      glz::for_each<N>([&](auto I) {
+        using Element = glz::detail::glaze_tuple_element<I, N, T>;
+        static constexpr size_t member_index = Element::member_index;
+        using val_t = std::remove_cvref_t<typename Element::type>;
+        if constexpr (std::same_as<val_t, glz::hidden> || std::same_as<val_t, glz::skip>) {
+          return;
+        } else {
+          decltype(auto) member = [&]() -> decltype(auto) {
+            if constexpr (glz::detail::reflectable<T>) {
+              return std::get<I>(t);
+            } else {
+              return glz::get<member_index>(glz::get<I>(glz::meta_v<std::decay_t<T>>));
+            }
+          }();
+          auto& member_ref = glz::detail::get_member(value, member);
+          from_dbus_binary<std::decay_t<decltype(member_ref)>>::template op<Opts>(member_ref, ctx, begin, it, end);
+        }
+      });
+      if constexpr (is_header<T>) {
+        // todo test
+        // The length of the header must be a multiple of 8, allowing the body to begin on an 8-byte boundary when storing
+        // the entire message in a single buffer. If the header does not naturally end on an 8-byte boundary up to 7 bytes
+        // of nul-initialized alignment padding must be added.
+        skip_padding<std::uint64_t>(ctx, begin, it, end);
+      }
     }
   }
 };
@@ -292,6 +485,22 @@ struct from_dbus_binary<T> {
 
 }  // namespace detail
 
+/// \brief Reads value from buffer starting at it, allocator aware members of value are allocated from resource
+/// \note To decode a whole message with a single allocation, pass an arena such as std::pmr::monotonic_buffer_resource and
+/// construct value with the same resource, e.g. header{ .fields = std::pmr::vector<field>{ resource } }
+template <typename T, typename Buffer>
+  requires std::is_lvalue_reference_v<T>
+[[nodiscard]] constexpr auto read_dbus_binary(T&& value,
+                                              Buffer&& buffer,
+                                              auto&& it,
+                                              std::pmr::memory_resource* resource) noexcept -> error {
+  context ctx{ .resource = resource };
+  // todo begin of buffer should be const, cbegin
+  detail::from_dbus_binary<std::decay_t<T>>::template op<{}>(value, ctx, std::begin(buffer), it,
+                                                             std::cend(buffer));
+  return ctx.err;
+}
+
 template <typename T, typename Buffer>
   requires std::is_lvalue_reference_v<T>
 [[nodiscard]] constexpr auto read_dbus_binary(T&& value, Buffer&& buffer, auto&& it) noexcept -> error {
@@ -309,6 +518,21 @@ template <typename T, typename Buffer>
   return read_dbus_binary(std::forward<T>(value), std::forward<Buffer>(buffer), std::move(it));
 }
 
+/// \brief Reads value from buffer whose values are in the byte order order, e.g. the body of a message in the
+/// header_view::byte_order() of its header. Values in the byte order of the host are copied as they are.
+template <typename T, typename Buffer>
+  requires std::is_lvalue_reference_v<T>
+[[nodiscard]] constexpr auto read_dbus_binary(T&& value,
+                                              Buffer&& buffer,
+                                              std::endian order,
+                                              std::pmr::memory_resource* resource = std::pmr::get_default_resource()) noexcept
+    -> error {
+  context ctx{ .resource = resource, .byte_swap = order != std::endian::native };
+  auto it{ std::begin(buffer) };
+  detail::from_dbus_binary<std::decay_t<T>>::template op<{}>(value, ctx, std::begin(buffer), it, std::cend(buffer));
+  return ctx.err;
+}
+
 template <typename T, class Buffer>
 [[nodiscard]] constexpr auto read_dbus_binary(Buffer&& buffer) noexcept -> glz::expected<T, error> {
   T value{};
@@ -319,4 +543,26 @@ template <typename T, class Buffer>
   return value;
 }
 
+template <typename T, class Buffer>
+[[nodiscard]] constexpr auto read_dbus_binary(Buffer&& buffer, std::pmr::memory_resource* resource) noexcept
+    -> glz::expected<T, error> {
+  auto value{ detail::make_element<T>(context{ .resource = resource }) };
+  auto err = read_dbus_binary(value, buffer, std::begin(buffer), resource);
+  if (err) [[unlikely]] {
+    return glz::unexpected(err);
+  }
+  return value;
+}
+
+template <typename T, class Buffer>
+[[nodiscard]] constexpr auto read_dbus_binary(Buffer&& buffer, std::endian order, std::pmr::memory_resource* resource) noexcept
+    -> glz::expected<T, error> {
+  auto value{ detail::make_element<T>(context{ .resource = resource }) };
+  auto err = read_dbus_binary(value, buffer, order, resource);
+  if (err) [[unlikely]] {
+    return glz::unexpected(err);
+  }
+  return value;
+}
+
 }  // namespace adbus::protocol
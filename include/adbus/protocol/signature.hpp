@@ -1,6 +1,8 @@
 #pragma once
 
 #include <cstdint>
+#include <memory_resource>
+#include <string>
 #include <string_view>
 #include <variant>
 #include <array>
@@ -21,29 +23,42 @@ namespace adbus::protocol::type {
 
 using std::string_view_literals::operator""sv;
 
+/// \brief A signature of at most 255 characters. Short signatures, which are most of them, are stored inline by the small
+/// buffer of the string, longer ones are allocated from the allocator, e.g. the arena a message is decoded into
 struct signature {
-  constexpr signature() noexcept = default;
-  constexpr explicit(false) signature(std::string_view sv) noexcept {
-    assert(sv.size() <= 255 && "signature size must be less than 255");
-    size_ = sv.size();
-    std::copy(std::begin(sv), std::end(sv), std::begin(data_));
-  }
-  constexpr explicit operator std::string_view() const noexcept { return { data_.data(), size_ }; }
-  [[nodiscard]] constexpr auto size() const noexcept -> std::uint8_t { return size_; }
-  [[nodiscard]] constexpr auto data() const noexcept -> decltype(auto) { return data_.data(); }
-  [[nodiscard]] constexpr auto data() noexcept -> decltype(auto) { return data_.data(); }
-  constexpr auto operator== (const signature& other) const noexcept -> bool {
-    return size_ == other.size_ && std::equal(std::begin(data_), std::begin(data_) + size_, std::begin(other.data_));
+  using allocator_type = std::pmr::polymorphic_allocator<>;
+  static constexpr std::size_t max_size{ 255 };
+
+  signature() = default;
+  explicit signature(allocator_type const& allocator) : buffer_{ allocator } {}
+  explicit(false) signature(std::string_view sv, allocator_type const& allocator = {}) : buffer_{ sv, allocator } {
+    assert(sv.size() <= max_size && "signature size must be less than 255");
   }
-  constexpr auto operator== (std::string_view sv) const noexcept -> bool {
-    return size_ == sv.size() && std::equal(std::begin(data_), std::begin(data_) + size_, std::begin(sv));
+  signature(signature const& other, allocator_type const& allocator) : buffer_{ other.buffer_, allocator } {}
+  signature(signature&& other, allocator_type const& allocator) : buffer_{ std::move(other.buffer_), allocator } {}
+  signature(signature const&) = default;
+  signature(signature&&) noexcept = default;
+  auto operator=(signature const&) -> signature& = default;
+  auto operator=(signature&&) noexcept -> signature& = default;
+  ~signature() = default;
+
+  [[nodiscard]] auto get_allocator() const noexcept -> allocator_type { return buffer_.get_allocator(); }
+  void assign(std::string_view sv) {
+    assert(sv.size() <= max_size && "signature size must be less than 255");
+    buffer_.assign(sv);
   }
+  explicit operator std::string_view() const noexcept { return buffer_; }
+  [[nodiscard]] auto size() const noexcept -> std::uint8_t { return static_cast<std::uint8_t>(buffer_.size()); }
+  [[nodiscard]] auto data() const noexcept -> char const* { return buffer_.data(); }
+  auto operator==(signature const& other) const noexcept -> bool { return buffer_ == other.buffer_; }
+  auto operator==(std::string_view sv) const noexcept -> bool { return buffer_ == sv; }
   static constexpr auto dbus_signature{ true }; // flag to indicate this is a dbus signature for concept
-  std::uint8_t size_{};
-  std::array<char, 255> data_{};
+
+private:
+  std::pmr::string buffer_{};
 };
 
-constexpr auto format_as(signature const& s) noexcept -> std::string_view {
+inline auto format_as(signature const& s) noexcept -> std::string_view {
   return std::string_view{ s };
 }
 
@@ -0,0 +1,210 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <variant>
+
+#include <glaze/concepts/container_concepts.hpp>
+#include <glaze/core/common.hpp>
+#include <glaze/core/reflection_tuple.hpp>
+#include <glaze/util/variant.hpp>
+
+#include <adbus/core/context.hpp>
+#include <adbus/protocol/fixed_layout.hpp>
+#include <adbus/protocol/padding.hpp>
+#include <adbus/protocol/signature.hpp>
+#include <adbus/util/concepts.hpp>
+
+namespace adbus::protocol {
+
+namespace detail {
+
+// Mirrors the write.hpp marshalling, but only advances the index. Padding depends on the position in the message so the
+// size is always computed from a given starting index.
+
+template <typename T>
+constexpr void size_padding(std::size_t& idx) noexcept {
+  constexpr auto alignment{ padding<T>::value };
+  idx += (alignment - (idx % alignment)) % alignment;
+}
+
+template <typename T>
+struct dbus_size_of;
+
+template <>
+struct dbus_size_of<bool> {
+  template <options Opts>
+  static constexpr void op(auto&&, std::size_t& idx) noexcept {
+    size_padding<std::uint32_t>(idx);
+    idx += sizeof(std::uint32_t);
+  }
+};
+
+template <num_t number_t>
+struct dbus_size_of<number_t> {
+  template <options Opts>
+  static constexpr void op(auto&&, std::size_t& idx) noexcept {
+    size_padding<number_t>(idx);
+    idx += sizeof(number_t);
+  }
+};
+
+template <typename T>
+  requires(std::is_enum_v<T> && !glz::detail::glaze_enum_t<T>)
+struct dbus_size_of<T> {
+  template <options Opts>
+  static constexpr void op(auto&& value, std::size_t& idx) noexcept {
+    dbus_size_of<std::underlying_type_t<T>>::template op<Opts>(std::to_underlying(value), idx);
+  }
+};
+
+template <string_like string_t>
+struct dbus_size_of<string_t> {
+  template <options Opts>
+  static constexpr void op(auto&& value, std::size_t& idx) noexcept {
+    size_padding<std::uint32_t>(idx);
+    // length, the string itself and the null terminator
+    idx += sizeof(std::uint32_t) + value.size() + 1;
+  }
+};
+
+template <typename T>
+  requires(std::is_enum_v<T> && glz::detail::glaze_enum_t<T>)
+struct dbus_size_of<T> {
+  template <options Opts>
+  static constexpr void op(auto&& value, std::size_t& idx) noexcept {
+    using key_t = std::underlying_type_t<T>;
+    static constexpr auto frozen_map = glz::detail::make_enum_to_string_map<T>();
+    const auto& member_it = frozen_map.find(static_cast<key_t>(value));
+    if (member_it != frozen_map.end()) {
+      const std::string_view str = { member_it->second.data(), member_it->second.size() };
+      dbus_size_of<std::string_view>::template op<Opts>(str, idx);
+    }
+  }
+};
+
+template <adbus::type::is_signature sign_t>
+struct dbus_size_of<sign_t> {
+  template <options Opts>
+  static constexpr void op(auto&& value, std::size_t& idx) noexcept {
+    // single byte length, the signature and the null terminator
+    idx += sizeof(std::uint8_t) + value.size() + 1;
+  }
+};
+
+template <container T>
+struct dbus_size_of<T> {
+  template <options Opts>
+  static constexpr void op(auto&& value, std::size_t& idx) noexcept {
+    size_padding<std::uint32_t>(idx);
+    idx += sizeof(std::uint32_t);
+    size_padding<typename std::decay_t<decltype(value)>::value_type>(idx);
+    if constexpr (adbus::type::contiguous_fixed<T>) {
+      idx += std::ranges::size(value) * sizeof(std::ranges::range_value_t<T>);
+    } else {
+      for (const auto& v : value) {
+        dbus_size_of<std::decay_t<decltype(v)>>::template op<Opts>(v, idx);
+      }
+    }
+  }
+};
+
+template <glz::detail::pair_t T>
+struct dbus_size_of<T> {
+  template <options Opts>
+  static constexpr void op(auto&& pair, std::size_t& idx) noexcept {
+    size_padding<std::uint64_t>(idx);
+    const auto& [key, value]{ pair };
+    dbus_size_of<typename T::first_type>::template op<Opts>(key, idx);
+    dbus_size_of<typename T::second_type>::template op<Opts>(value, idx);
+  }
+};
+
+template <glz::is_variant T>
+struct dbus_size_of<T> {
+  template <options Opts>
+  static constexpr void op(auto&& variant, std::size_t& idx) noexcept {
+    std::visit(
+        [&](auto&& value) {
+          using V = std::decay_t<decltype(value)>;
+          idx += sizeof(std::uint8_t) + type::signature_v<V>.size() + 1;
+          dbus_size_of<V>::template op<Opts>(value, idx);
+        },
+        variant);
+  }
+};
+
+template <typename T>
+  requires(glz::detail::glaze_object_t<T> || glz::detail::reflectable<T>)
+struct dbus_size_of<T> {
+  static constexpr auto N = glz::reflection_count<T>;
+
+  template <options Opts>
+  static constexpr void op(auto&& value, std::size_t& idx) noexcept {
+    if constexpr (fixed_struct<T>) {
+      size_padding<std::uint64_t>(idx);
+      idx += fixed_layout<T>::size;
+    } else {
+      decltype(auto) t = glz::detail::reflection_tuple<T>(value);
+      size_padding<std::uint64_t>(idx);
+      glz::for_each<N>([&](auto I) {
+        using Element = glz::detail::glaze_tuple_element<I, N, T>;
+        static constexpr size_t member_index = Element::member_index;
+        using val_t = std::remove_cvref_t<typename Element::type>;
+        if constexpr (std::same_as<val_t, glz::hidden> || std::same_as<val_t, glz::skip>) {
+          return;
+        } else {
+          decltype(auto) member = [&]() -> decltype(auto) {
+            if constexpr (glz::detail::reflectable<T>) {
+              return std::get<I>(t);
+            } else {
+              return glz::get<member_index>(glz::get<I>(glz::meta_v<std::decay_t<T>>));
+            }
+          }();
+          auto& member_ref = glz::detail::get_member(value, member);
+          dbus_size_of<std::decay_t<decltype(member_ref)>>::template op<Opts>(member_ref, idx);
+        }
+      });
+      if constexpr (is_header<T>) {
+        size_padding<std::uint64_t>(idx);
+      }
+    }
+  }
+};
+
+template <glz::detail::glaze_value_t T>
+struct dbus_size_of<T> {
+  template <options Opts>
+  static constexpr void op(auto&& value, std::size_t& idx) noexcept {
+    using V = decltype(glz::detail::get_member(std::declval<T>(), glz::meta_wrapper_v<T>));
+    dbus_size_of<std::decay_t<V>>::template op<Opts>(glz::detail::get_member(value, glz::meta_wrapper_v<T>), idx);
+  }
+};
+
+}  // namespace detail
+
+/// \brief The exact number of bytes write_dbus_binary appends for value when writing starts at offset
+/// \note The offset matters since padding is relative to the beginning of the message
+[[nodiscard]] constexpr auto dbus_size(auto&& value, std::size_t offset = 0) noexcept -> std::size_t {
+  std::size_t idx{ offset };
+  detail::dbus_size_of<std::decay_t<decltype(value)>>::template op<{}>(value, idx);
+  return idx - offset;
+}
+
+/// \brief Marshalled size of a fixed type or a fixed_struct, which does not depend on the value, usable in constant
+/// expressions. The size of a struct is counted from its 8-byte aligned beginning.
+template <typename T>
+  requires(adbus::type::fixed<T> || fixed_struct<std::remove_cvref_t<T>>)
+inline constexpr std::size_t dbus_fixed_size_v{ [] {
+  if constexpr (fixed_struct<std::remove_cvref_t<T>>) {
+    return detail::fixed_layout<std::remove_cvref_t<T>>::size;
+  } else {
+    return dbus_size(std::remove_cvref_t<T>{});
+  }
+}() };
+
+static_assert(dbus_fixed_size_v<std::uint8_t> == 1);
+static_assert(dbus_fixed_size_v<bool> == 4);
+static_assert(dbus_fixed_size_v<double> == 8);
+
+}  // namespace adbus::protocol
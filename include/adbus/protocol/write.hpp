@@ -2,6 +2,7 @@
 
 #include <cstring>
 #include <expected>
+#include <span>
 #include <type_traits>
 
 #include <glaze/concepts/container_concepts.hpp>
@@ -10,8 +11,11 @@
 #include <glaze/util/variant.hpp>
 
 #include <adbus/core/context.hpp>
+#include <adbus/protocol/fixed_layout.hpp>
+#include <adbus/protocol/gather_buffer.hpp>
 #include <adbus/protocol/padding.hpp>
 #include <adbus/protocol/signature.hpp>
+#include <adbus/protocol/size.hpp>
 #include <adbus/util/concepts.hpp>
 
 namespace adbus::protocol {
@@ -65,51 +69,91 @@ struct write;
 
 constexpr void resize(auto&& buffer, auto&& idx, auto&& n) noexcept {
   if (idx + n > buffer.size()) [[unlikely]] {
-    buffer.resize((std::max)(buffer.size() * 2, idx + n));
+    if constexpr (is_gather_buffer<std::decay_t<decltype(buffer)>>) {
+      // the logical size includes referenced payloads, doubling it would allocate for bytes which are never copied
+      buffer.resize(idx + n);
+    } else {
+      buffer.resize((std::max)(buffer.size() * 2, idx + n));
+    }
+  }
+}
+
+// Pointer to the output byte at idx, buffers which keep part of the output elsewhere map the index themselves
+[[nodiscard]] constexpr auto data_at(auto&& buffer, std::size_t idx) noexcept {
+  if constexpr (is_gather_buffer<std::decay_t<decltype(buffer)>>) {
+    return buffer.data_at(idx);
+  } else {
+    return std::data(buffer) + idx;
+  }
+}
+
+// Makes room for n bytes at idx, resizable buffers grow while fixed capacity buffers report that they are too small
+[[nodiscard]] constexpr auto ensure(is_context auto&& ctx, auto&& buffer, auto&& idx, auto&& n) noexcept -> bool {
+  if constexpr (glz::resizable<std::decay_t<decltype(buffer)>>) {
+    resize(buffer, idx, n);
+  } else if (idx + n > buffer.size()) [[unlikely]] {
+    ctx.err = error{ .code = error_code::buffer_too_small, .index = idx };
+    return false;
   }
+  return true;
 }
 
 template <typename T>
-constexpr void pad(auto&& buffer, auto&& idx) noexcept {
+constexpr void pad(is_context auto&& ctx, auto&& buffer, auto&& idx) noexcept {
   constexpr auto alignment{ padding<T>::value };
   // idx % alignment: This computes the offset of idx from the nearest previous alignment boundary.
   // alignment - (idx % alignment): This calculates how much padding is needed to reach the next alignment boundary.
   // (alignment - (idx % alignment)) % alignment: This ensures that if idx is already aligned (i.e., idx % alignment == 0),
   // the padding is 0 instead of alignment.
   const auto padding = (alignment - (idx % alignment)) % alignment;
-  resize(buffer, idx, padding);
-  std::memset(buffer.data() + idx, 0, padding);
+  if (!ensure(ctx, buffer, idx, padding)) [[unlikely]] {
+    return;
+  }
+  std::memset(data_at(buffer, idx), 0, padding);
   idx += padding;
 }
 
 constexpr void dbus_marshall(arithmetic auto&& value,
-                             [[maybe_unused]] is_context auto&& ctx,
+                             is_context auto&& ctx,
                              auto&& buffer,
                              auto&& idx) noexcept {
   using V = std::decay_t<decltype(value)>;
-  pad<V>(buffer, idx);
+  pad<V>(ctx, buffer, idx);
   constexpr auto n = sizeof(V);
-  if constexpr (glz::resizable<std::decay_t<decltype(buffer)>>) {
-    resize(buffer, idx, n);
-  } else {
-    if (idx + n > buffer.size()) [[unlikely]] {
-      ctx.err = error{ .code = error_code::buffer_too_small };
-      return;
-    }
+  if (ctx.err || !ensure(ctx, buffer, idx, n)) [[unlikely]] {
+    return;
   }
 
   constexpr auto is_volatile = std::is_volatile_v<std::remove_reference_t<decltype(value)>>;
 
   if constexpr (is_volatile) {
     const V temp{ value };
-    std::memcpy(buffer.data() + idx, &temp, n);
+    std::memcpy(data_at(buffer, idx), &temp, n);
   } else {
-    std::memcpy(buffer.data() + idx, &value, n);
+    std::memcpy(data_at(buffer, idx), &value, n);
   }
 
   idx += n;
 }
 
+// Copies n bytes of data to idx, a gather buffer references payloads from its threshold on instead
+constexpr void write_bytes(is_context auto&& ctx, auto&& buffer, auto&& idx, const void* data, std::size_t n) noexcept {
+  if constexpr (is_gather_buffer<std::decay_t<decltype(buffer)>>) {
+    if (n >= buffer.threshold()) {
+      buffer.append_external(idx, std::span{ static_cast<const std::byte*>(data), n });
+      idx += n;
+      return;
+    }
+  }
+  if (!ensure(ctx, buffer, idx, n)) [[unlikely]] {
+    return;
+  }
+  if (n > 0) {
+    std::memcpy(data_at(buffer, idx), data, n);
+  }
+  idx += n;
+}
+
 template <typename T>
 struct to_dbus_binary : std::false_type {};
 
@@ -149,12 +193,15 @@ struct to_dbus_binary<string_t> {
     }
     const auto n{ static_cast<std::uint32_t>(value.size()) };
     dbus_marshall(n, ctx, buffer, idx);
-    // todo for fixed buffer, we need to check if we still have space
-    // +1 for the null terminator
-    resize(buffer, idx, n + 1);
-    std::memcpy(buffer.data() + idx, value.data(), n);
-    idx += n;
-    buffer[idx++] = '\0';
+    if (ctx.err) [[unlikely]] {
+      return;
+    }
+    write_bytes(ctx, buffer, idx, value.data(), n);
+    // the null terminator
+    if (ctx.err || !ensure(ctx, buffer, idx, 1)) [[unlikely]] {
+      return;
+    }
+    *data_at(buffer, idx++) = {};
   }
 };
 
@@ -179,13 +226,15 @@ struct to_dbus_binary<T> {
 template <adbus::type::is_signature sign_t>
 struct to_dbus_binary<sign_t> {
   template <options Opts>
-  static constexpr void op(auto&& value, [[maybe_unused]] is_context auto&& ctx, auto&& buffer, auto&& idx) noexcept {
+  static constexpr void op(auto&& value, is_context auto&& ctx, auto&& buffer, auto&& idx) noexcept {
     const auto n{ static_cast<std::uint8_t>(value.size()) };
     dbus_marshall(n, ctx, buffer, idx);
-    resize(buffer, idx, n + 1);
-    std::memcpy(buffer.data() + idx, value.data(), n);
+    if (ctx.err || !ensure(ctx, buffer, idx, n + 1)) [[unlikely]] {
+      return;
+    }
+    std::memcpy(data_at(buffer, idx), value.data(), n);
     idx += n;
-    buffer[idx++] = '\0';
+    *data_at(buffer, idx++) = {};
   }
 };
 
@@ -195,7 +244,7 @@ struct to_dbus_binary<T> {
   // n does not include the padding after the length, or any padding after the last element. i.e. n should be divisible by
   // the number of elements in the array
   template <options Opts>
-  static constexpr void op(auto&& value, [[maybe_unused]] is_context auto&& ctx, auto&& buffer, auto&& idx) noexcept {
+  static constexpr void op(auto&& value, is_context auto&& ctx, auto&& buffer, auto&& idx) noexcept {
     if constexpr (map_like<T>) {
       // the first single complete type (the "key") must be a basic type rather than a container type
 #if __cpp_static_assert >= 202306L
@@ -212,13 +261,32 @@ struct to_dbus_binary<T> {
     }
 
     std::uint32_t size_placeholder{};
-    pad<decltype(size_placeholder)>(buffer, idx);  // let's manually pad here to get the REAL index of the placeholder
+    pad<decltype(size_placeholder)>(ctx, buffer, idx);  // let's manually pad here to get the REAL index of the placeholder
     const auto placeholder_idx{ idx };
     dbus_marshall(size_placeholder, ctx, buffer, idx);
-    pad<typename std::decay_t<decltype(value)>::value_type>(buffer, idx);  // n does not include the padding after the length
+    if (ctx.err) [[unlikely]] {
+      return;
+    }
+    // n does not include the padding after the length
+    pad<typename std::decay_t<decltype(value)>::value_type>(ctx, buffer, idx);
+    if (ctx.err) [[unlikely]] {
+      return;
+    }
     const auto beginning_of_data_idx{ idx };
-    for (const auto& v : value) {
-      to_dbus_binary<std::decay_t<decltype(v)>>::template op<Opts>(v, ctx, buffer, idx);
+    if constexpr (adbus::type::contiguous_fixed<T>) {
+      // The elements are naturally aligned and there is no padding in between, so the whole array data is a single copy
+      write_bytes(ctx, buffer, idx, std::ranges::data(value),
+                  std::ranges::size(value) * sizeof(std::ranges::range_value_t<T>));
+      if (ctx.err) [[unlikely]] {
+        return;
+      }
+    } else {
+      for (const auto& v : value) {
+        to_dbus_binary<std::decay_t<decltype(v)>>::template op<Opts>(v, ctx, buffer, idx);
+        if (ctx.err) [[unlikely]] {
+          return;
+        }
+      }
     }
     const auto bytes{ idx - beginning_of_data_idx };
     if (bytes > std::numeric_limits<std::uint32_t>::max()) [[unlikely]] {
@@ -226,19 +294,25 @@ struct to_dbus_binary<T> {
       return;
     }
     const auto n{ static_cast<std::uint32_t>(bytes) };
-    std::memcpy(buffer.data() + placeholder_idx, &n, sizeof(n));
+    std::memcpy(data_at(buffer, placeholder_idx), &n, sizeof(n));
   }
 };
 
 template <glz::detail::pair_t T>
 struct to_dbus_binary<T> {
   template <options Opts>
-  static constexpr void op(auto&& pair, [[maybe_unused]] is_context auto&& ctx, auto&&... args) noexcept {
+  static constexpr void op(auto&& pair, is_context auto&& ctx, auto&&... args) noexcept {
     // A struct must start on an 8-byte boundary regardless of the type of the struct fields.
     // DICT_ENTRY          Identical to STRUCT.
-    pad<std::uint64_t>(args...);
+    pad<std::uint64_t>(ctx, args...);
+    if (ctx.err) [[unlikely]] {
+      return;
+    }
     const auto& [key, value]{ pair };
     to_dbus_binary<typename T::first_type>::template op<Opts>(key, ctx, args...);
+    if (ctx.err) [[unlikely]] {
+      return;
+    }
     to_dbus_binary<typename T::second_type>::template op<Opts>(value, ctx, args...);
   }
 };
@@ -246,13 +320,16 @@ struct to_dbus_binary<T> {
 template <glz::is_variant T>
 struct to_dbus_binary<T> {
   template <options Opts>
-  static constexpr void op(auto&& variant, auto&&... args) noexcept {
+  static constexpr void op(auto&& variant, is_context auto&& ctx, auto&&... args) noexcept {
     std::visit(
         [&](auto&& value) {
           using V = std::decay_t<decltype(value)>;
-          constexpr auto signature{ type::signature(type::signature_v<V>) };
-          to_dbus_binary<decltype(signature)>::op<Opts>(signature, args...);
-          to_dbus_binary<V>::template op<Opts>(value, args...);
+          // the signature writer only needs size() and data(), so the string_view is written without a copy
+          to_dbus_binary<type::signature>::template op<Opts>(type::signature_v<V>, ctx, args...);
+          if (ctx.err) [[unlikely]] {
+            return;
+          }
+          to_dbus_binary<V>::template op<Opts>(value, ctx, args...);
         },
         variant);
   }
@@ -266,32 +343,47 @@ struct to_dbus_binary<T> {
   // mostly copied from glaze binary/write.hpp
   template <options Opts>
   static constexpr void op(auto&& value, is_context auto&& ctx, auto&& buffer, auto&& idx) noexcept {
-    decltype(auto) t = glz::detail::reflection_tuple<T>(value);
-    // A struct must start on an 8-byte boundary regardless of the type of the struct fields
-    pad<std::uint64_t>(buffer, idx);
-    glz::for_each<N>([&](auto I) {
-      using Element = glz::detail::glaze_tuple_element<I, N, T>;
-      static constexpr size_t member_index = Element::member_index;
-      using val_t = std::remove_cvref_t<typename Element::type>;
-      if constexpr (std::same_as<val_t, glz::hidden> || std::same_as<val_t, glz::skip>) {
+    if constexpr (fixed_struct<T>) {
+      // Every member is at a known offset from the aligned beginning, so the struct is written as one block
+      pad<std::uint64_t>(ctx, buffer, idx);
+      if (ctx.err || !ensure(ctx, buffer, idx, fixed_layout<T>::size)) [[unlikely]] {
         return;
-      } else {
-        decltype(auto) member = [&]() -> decltype(auto) {
-          if constexpr (glz::detail::reflectable<T>) {
-            return std::get<I>(t);
-          } else {
-            return glz::get<member_index>(glz::get<I>(glz::meta_v<std::decay_t<T>>));
-          }
-        }();
-        auto& member_ref = glz::detail::get_member(value, member);
-        to_dbus_binary<std::decay_t<decltype(member_ref)>>::template op<Opts>(member_ref, ctx, buffer, idx);
       }
-    });
-    if constexpr (is_header<T>) {
-      // The length of the header must be a multiple of 8, allowing the body to begin on an 8-byte boundary when storing the
-      // entire message in a single buffer. If the header does not naturally end on an 8-byte boundary up to 7 bytes of
-      // nul-initialized alignment padding must be added.
-      pad<std::uint64_t>(buffer, idx);
+      fixed_layout<T>::encode(value, data_at(buffer, idx));
+      idx += fixed_layout<T>::size;
+    } else {
+      decltype(auto) t = glz::detail::reflection_tuple<T>(value);
+      // A struct must start on an 8-byte boundary regardless of the type of the struct fields
+      pad<std::uint64_t>(ctx, buffer, idx);
+      glz::for_each<N>([&](auto I) {
+        if (ctx.err) [[unlikely]] {
+          return;
+        }
+        using Element = glz::detail::glaze_tuple_element<I, N, T>;
+        static constexpr size_t member_index = Element::member_index;
+        using val_t = std::remove_cvref_t<typename Element::type>;
+        if constexpr (std::same_as<val_t, glz::hidden> || std::same_as<val_t, glz::skip>) {
+          return;
+        } else {
+          decltype(auto) member = [&]() -> decltype(auto) {
+            if constexpr (glz::detail::reflectable<T>) {
+              return std::get<I>(t);
+            } else {
+              return glz::get<member_index>(glz::get<I>(glz::meta_v<std::decay_t<T>>));
+            }
+          }();
+          auto& member_ref = glz::detail::get_member(value, member);
+          to_dbus_binary<std::decay_t<decltype(member_ref)>>::template op<Opts>(member_ref, ctx, buffer, idx);
+        }
+      });
+      if constexpr (is_header<T>) {
+        // The length of the header must be a multiple of 8, allowing the body to begin on an 8-byte boundary when storing
+        // the entire message in a single buffer. If the header does not naturally end on an 8-byte boundary up to 7 bytes
+        // of nul-initialized alignment padding must be added.
+        if (!ctx.err) [[likely]] {
+          pad<std::uint64_t>(ctx, buffer, idx);
+        }
+      }
     }
   }
 };
@@ -309,15 +401,36 @@ struct to_dbus_binary<T> {
 
 }  // namespace detail
 
-constexpr auto write_dbus_binary(auto&& value, auto&& buffer) noexcept -> error {
+/// \brief Writes value into buffer starting at idx, on return idx is one past the last byte written
+/// \note Resizable buffers are grown to fit, fixed capacity buffers such as std::array or std::span are never resized and
+/// report error_code::buffer_too_small when value does not fit
+constexpr auto write_dbus_binary(auto&& value, auto&& buffer, std::size_t& idx) noexcept -> error {
   context ctx{};
-  std::size_t idx{ buffer.size() };
+  if constexpr (glz::resizable<std::decay_t<decltype(buffer)>> && !is_gather_buffer<std::decay_t<decltype(buffer)>>) {
+    // Allocate once up front instead of growing the buffer while writing, oversized values are left to the writer to
+    // report as errors
+    if (const auto size{ dbus_size(value, idx) }; size <= std::numeric_limits<std::uint32_t>::max()) [[likely]] {
+      if (idx + size > buffer.size()) {
+        buffer.resize(idx + size);
+      }
+    }
+  }
   detail::to_dbus_binary<std::decay_t<decltype(value)>>::template op<{}>(std::forward<decltype(value)>(value), ctx, buffer,
                                                                          idx);
+  return ctx.err;
+}
+
+/// \brief Appends value to a resizable buffer, or writes it from the beginning of a fixed capacity buffer
+constexpr auto write_dbus_binary(auto&& value, auto&& buffer) noexcept -> error {
   if constexpr (glz::resizable<std::decay_t<decltype(buffer)>>) {
+    std::size_t idx{ buffer.size() };
+    auto err{ write_dbus_binary(std::forward<decltype(value)>(value), buffer, idx) };
     buffer.resize(idx);
+    return err;
+  } else {
+    std::size_t idx{};
+    return write_dbus_binary(std::forward<decltype(value)>(value), buffer, idx);
   }
-  return ctx.err;
 }
 
 template <typename buffer_t = std::string>
@@ -329,4 +442,57 @@ constexpr auto write_dbus_binary(auto&& value) noexcept -> std::expected<buffer_
   return buffer;
 }
 
+// The maximum length of a message, including header, header alignment padding, and body is 2 to the 27th power or
+// 134217728 (128 MiB)
+inline constexpr std::size_t max_message_length{ std::size_t{ 1 } << 27 };
+
+/// \brief Writes a complete message, the header followed by the body, into buffer in a single pass
+/// \note Both sizes are computed up front so the buffer is allocated once and body_length of the written header is patched
+/// in place, the header value itself is left untouched. Use glz::skip as body for messages without arguments.
+constexpr auto write_dbus_message(is_header auto&& header, auto&& body, auto&& buffer) noexcept -> error {
+  constexpr bool has_body{ !std::same_as<std::decay_t<decltype(body)>, glz::skip> };
+  // Padding is relative to the start of the message, so a message is always written from the beginning of the buffer
+  const auto header_size{ dbus_size(header) };
+  std::size_t body_size{};
+  if constexpr (has_body) {
+    body_size = dbus_size(body, header_size);
+  }
+  if (header_size + body_size > max_message_length) [[unlikely]] {
+    return error{ .code = error_code::message_too_long };
+  }
+  if constexpr (glz::resizable<std::decay_t<decltype(buffer)>> && !is_gather_buffer<std::decay_t<decltype(buffer)>>) {
+    buffer.resize(header_size + body_size);
+  } else if constexpr (is_gather_buffer<std::decay_t<decltype(buffer)>>) {
+    buffer.clear();
+  }
+  context ctx{};
+  std::size_t idx{};
+  detail::to_dbus_binary<std::decay_t<decltype(header)>>::template op<{}>(header, ctx, buffer, idx);
+  if (ctx.err) [[unlikely]] {
+    return ctx.err;
+  }
+  if constexpr (has_body) {
+    detail::to_dbus_binary<std::decay_t<decltype(body)>>::template op<{}>(body, ctx, buffer, idx);
+    if (ctx.err) [[unlikely]] {
+      return ctx.err;
+    }
+  }
+  // endian, type, flags and version precede the body length
+  constexpr std::size_t body_length_offset{ 4 };
+  const auto body_length{ static_cast<std::uint32_t>(idx - header_size) };
+  std::memcpy(detail::data_at(buffer, body_length_offset), &body_length, sizeof(body_length));
+  if constexpr (glz::resizable<std::decay_t<decltype(buffer)>>) {
+    buffer.resize(idx);
+  }
+  return {};
+}
+
+template <typename buffer_t = std::string>
+constexpr auto write_dbus_message(is_header auto&& header, auto&& body) noexcept -> std::expected<buffer_t, error> {
+  buffer_t buffer{};
+  if (auto err = write_dbus_message(header, body, buffer)) {
+    return std::unexpected(err);
+  }
+  return buffer;
+}
 }  // namespace adbus::protocol
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include <adbus/util/simd.hpp>
+
+namespace adbus::util {
+
+namespace detail {
+
+template <std::size_t size>
+struct uint_of;
+template <>
+struct uint_of<2> {
+  using type = std::uint16_t;
+};
+template <>
+struct uint_of<4> {
+  using type = std::uint32_t;
+};
+template <>
+struct uint_of<8> {
+  using type = std::uint64_t;
+};
+
+// Byte shuffle which reverses every element of size bytes within a block of N bytes
+template <std::size_t size, std::size_t N>
+inline constexpr auto reverse_elements = [] {
+  std::array<char, N> output{};
+  for (std::size_t idx{}; idx < N; ++idx) {
+    output[idx] = static_cast<char>(idx / size * size + (size - 1 - idx % size));
+  }
+  return output;
+}();
+
+// Swaps the elements of size bytes in the first bytes of input one at a time
+template <std::size_t size>
+inline void byteswap_scalar(unsigned char* output, unsigned char const* input, std::size_t bytes) noexcept {
+  using uint_t = typename uint_of<size>::type;
+  for (std::size_t idx{}; idx < bytes; idx += size) {
+    uint_t element{};
+    std::memcpy(&element, input + idx, size);
+    element = std::byteswap(element);
+    std::memcpy(output + idx, &element, size);
+  }
+}
+
+#if defined(ADBUS_SIMD_DISPATCH)
+// Swaps the whole 16 byte blocks of the first bytes of input
+// \return the number of bytes swapped
+template <std::size_t size>
+__attribute__((target("ssse3"))) inline auto byteswap_ssse3(unsigned char* output,
+                                                             unsigned char const* input,
+                                                             std::size_t bytes) noexcept -> std::size_t {
+  auto const mask{ _mm_loadu_si128(reinterpret_cast<__m128i const*>(reverse_elements<size, 16>.data())) };
+  std::size_t idx{};
+  for (; idx + 16 <= bytes; idx += 16) {
+    auto const block{ _mm_loadu_si128(reinterpret_cast<__m128i const*>(input + idx)) };
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(output + idx), _mm_shuffle_epi8(block, mask));
+  }
+  return idx;
+}
+
+// Swaps the whole 32 byte blocks of the first bytes of input
+// \return the number of bytes swapped
+template <std::size_t size>
+__attribute__((target("avx2"))) inline auto byteswap_avx2(unsigned char* output,
+                                                           unsigned char const* input,
+                                                           std::size_t bytes) noexcept -> std::size_t {
+  // the shuffle works within each 16 byte lane, the pattern repeats since 16 is a multiple of size
+  auto const mask{ _mm256_loadu_si256(reinterpret_cast<__m256i const*>(reverse_elements<size, 32>.data())) };
+  std::size_t idx{};
+  for (; idx + 32 <= bytes; idx += 32) {
+    auto const block{ _mm256_loadu_si256(reinterpret_cast<__m256i const*>(input + idx)) };
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + idx), _mm256_shuffle_epi8(block, mask));
+  }
+  return idx;
+}
+#endif
+
+}  // namespace detail
+
+/// \brief value with its bytes in reverse order, for integers, floating point and enums alike
+template <typename T>
+  requires(std::is_trivially_copyable_v<T> && (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8))
+[[nodiscard]] constexpr auto byteswap(T value) noexcept -> T {
+  if constexpr (sizeof(T) == 1) {
+    return value;
+  } else {
+    using uint_t = typename detail::uint_of<sizeof(T)>::type;
+    return std::bit_cast<T>(std::byteswap(std::bit_cast<uint_t>(value)));
+  }
+}
+
+/// \brief Copies count elements of size bytes from input to output, reversing the bytes of every element
+/// \note Whole blocks go through a byte shuffle, 32 bytes at a time with AVX2 and 16 with SSSE3, the rest is swapped one
+/// element at a time. The shuffle is chosen at run time by supported_simd(). Input and output may be unaligned but must
+/// not overlap.
+template <std::size_t size>
+  requires(size == 2 || size == 4 || size == 8)
+inline void byteswap_copy(void* output, void const* input, std::size_t count) noexcept {
+  auto* const out{ static_cast<unsigned char*>(output) };
+  auto const* const in{ static_cast<unsigned char const*>(input) };
+  std::size_t const bytes{ count * size };
+  std::size_t idx{};
+#if defined(ADBUS_SIMD_DISPATCH)
+  switch (supported_simd()) {
+    case simd_level::avx2:
+      idx = detail::byteswap_avx2<size>(out, in, bytes);
+      [[fallthrough]];
+    case simd_level::ssse3:
+      idx += detail::byteswap_ssse3<size>(out + idx, in + idx, bytes - idx);
+      break;
+    case simd_level::none:
+      break;
+  }
+#endif
+  detail::byteswap_scalar<size>(out + idx, in + idx, bytes - idx);
+}
+
+}  // namespace adbus::util
@@ -1,7 +1,11 @@
 #pragma once
 
+#include <array>
 #include <concepts>
 #include <cstdint>
+#include <ranges>
+#include <span>
+#include <vector>
 
 #include <glaze/concepts/container_concepts.hpp>
 
@@ -45,6 +49,12 @@ concept array_like = detail::fixed_size<T> && glz::detail::accessible<T> && glz:
 template <typename T>
 concept container = glz::range<T> && !string_like<T>;
 
+template <typename T>
+concept is_span = requires {
+  typename T::element_type;
+  requires std::same_as<std::remove_cv_t<T>, std::span<typename T::element_type, T::extent>>;
+};
+
 template <class T>
 concept has_clear = requires(T v) { v.clear(); };
 
@@ -53,6 +63,12 @@ concept is_header = requires {
   { T::message_header } -> std::convertible_to<const bool&>;
 };
 
+// output buffers which keep large payloads by reference instead of copying them, see protocol::gather_buffer
+template <typename T>
+concept is_gather_buffer = requires {
+  { T::gathered } -> std::convertible_to<const bool&>;
+};
+
 template <typename T>
 concept has_co_await = requires(T t) {
   { operator co_await(t) } -> std::convertible_to<std::coroutine_handle<>>;
@@ -88,6 +104,18 @@ static_assert(fixed<double>);
 template <typename type_t>
 concept basic = fixed<type_t> || glz::detail::string_like<type_t>;
 
+// Contiguous range of fixed types, whose in memory representation is identical to the marshalled array data in native byte
+// order, each element is naturally aligned so there is no padding in between. bool is excluded since it is marshalled as
+// UINT32.
+template <typename type_t>
+concept contiguous_fixed = std::ranges::contiguous_range<type_t> && std::ranges::sized_range<type_t> &&
+                           fixed<std::ranges::range_value_t<type_t>> &&
+                           !std::same_as<std::ranges::range_value_t<type_t>, bool>;
+static_assert(contiguous_fixed<std::array<std::uint64_t, 3>>);
+static_assert(contiguous_fixed<std::vector<std::uint8_t>>);
+static_assert(!contiguous_fixed<std::vector<bool>>);
+static_assert(!contiguous_fixed<std::array<bool, 3>>);
+
 // ARRAY, STRUCT, DICT_ENTRY, VARIANT
 // Todo make this more generalized
 // template <typename type_t>
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+
+// x86 code paths are compiled with __attribute__((target)) and chosen at run time, so a build for the baseline
+// instruction set still uses them. Other compilers and architectures only get the portable code.
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define ADBUS_SIMD_DISPATCH 1
+#include <immintrin.h>
+#endif
+
+namespace adbus::util {
+
+/// \brief The widest x86 vector extension a code path may use, each level implies the ones before it
+enum struct simd_level : std::uint8_t { none, ssse3, avx2 };
+
+/// \brief The widest extension supported by the CPU, detected once
+/// \note Known at compile time when the whole program is built for it, e.g. with -mavx2 or -march=native
+[[nodiscard]] inline auto supported_simd() noexcept -> simd_level {
+#if defined(__AVX2__)
+  return simd_level::avx2;
+#elif defined(ADBUS_SIMD_DISPATCH)
+  static simd_level const level{ [] {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+      return simd_level::avx2;
+    }
+    if (__builtin_cpu_supports("ssse3")) {
+      return simd_level::ssse3;
+    }
+    return simd_level::none;
+  }() };
+  return level;
+#else
+  return simd_level::none;
+#endif
+}
+
+}  // namespace adbus::util
@@ -1,28 +1,33 @@
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
 #include <mutex>
+#include <optional>
 #include <regex>
 #include <type_traits>
+#include <vector>
 
 #include <fmt/format.h>
 #include <boost/asio.hpp>
 #include <glaze/util/expected.hpp>
 
+#include <adbus/core/buffer_pool.hpp>
+#include <adbus/core/completion_slot.hpp>
+#include <adbus/core/object_server.hpp>
+#include <adbus/core/serial_counter.hpp>
+#include <adbus/core/serial_map.hpp>
+#include <adbus/core/sharded_executor.hpp>
+#include <adbus/core/signal_router.hpp>
+#include <adbus/core/write_queue.hpp>
+#include <adbus/protocol/header_view.hpp>
+#include <adbus/protocol/match_rule.hpp>
 #include <adbus/protocol/message_header.hpp>
 #include <adbus/protocol/methods.hpp>
 #include <adbus/protocol/read.hpp>
 #include <adbus/protocol/signature.hpp>
 #include <adbus/protocol/write.hpp>
 
-// todo properly use this dependency by namespacing it or use package manager
-#define BOOST_SAM_HEADER_ONLY  // todo make this optional
-#include <adbus/ext/boost/sam/condition_variable.hpp>
-namespace adbus {
-#ifdef BOOST_SAM_STANDALONE
-using condition_variable = sam::basic_condition_variable<asio::any_io_executor>;
-#else
-using condition_variable = boost::sam::basic_condition_variable<boost::asio::any_io_executor>;
-#endif
-}  // namespace adbus
-
 namespace adbus {
 
 namespace api {
@@ -57,42 +62,57 @@ namespace asio = boost::asio;
 
 namespace detail {
 
+template <typename T>
+struct is_awaitable : std::false_type {};
+template <typename T, typename executor_t>
+struct is_awaitable<asio::awaitable<T, executor_t>> : std::true_type {};
+
+/// \brief A received message, the header views the bytes held alongside it
+struct incoming_message {
+  incoming_message() = default;
+  incoming_message(protocol::header::header_view view, std::string&& message)
+      : bytes{ std::move(message) }, header{ view.rebind(bytes) } {}
+  // moving the string may move the bytes, small strings are stored inline
+  incoming_message(incoming_message&& other) noexcept
+      : bytes{ std::move(other.bytes) }, header{ other.header.rebind(bytes) } {}
+  auto operator=(incoming_message&& other) noexcept -> incoming_message& {
+    bytes = std::move(other.bytes);
+    header = other.header.rebind(bytes);
+    return *this;
+  }
+
+  std::string bytes{};
+  protocol::header::header_view header{};
+};
+
 class incoming_message_queue {
 public:
-  incoming_message_queue() = default;
-  [[nodiscard]] auto on_message(is_header auto&& header, std::string&& message) -> std::error_code {
-    std::scoped_lock lock{ mutex_ };
-    if (message_queue_.empty()) {
-      // is this an error? don't think so
-      return {};
-    }
-    switch (header.type) {
+  template <typename executor_t>
+  explicit incoming_message_queue(executor_t const& executor) : executor_{ executor } {}
+
+  /// \param header view into message, which holds the whole message, header and body
+  [[nodiscard]] auto on_message(protocol::header::header_view header, std::string&& message) -> std::error_code {
+    switch (header.type()) {
       using enum protocol::header::message_type_e;
       case method_return: {
-        auto const reply_serial{ header.reply_serial() };
-        auto it = std::ranges::find_if(message_queue_,
-                                       [reply_serial](auto&& event) { return event->wait_header.serial == reply_serial; });
-        if (it == message_queue_.end()) {
-          fmt::println(stderr, "error: serial {} not found", reply_serial.value_or(0));
-          // todo custom error_code
-          return std::make_error_code(std::errc::bad_message);
-        }
-        (*it)->message = std::move(message);
-        (*it)->recv_header = std::forward<decltype(header)>(header);
-        (*it)->cv.notify_all();
-        message_queue_.erase(it);
-        break;
+        return on_reply(header.reply_serial().value_or(0), incoming_message{ header, std::move(message) });
       }
       case error: {
         // todo implement
         break;
       }
       case signal: {
-        // todo implement
+        // subscribers run on the read loop, message outlives the dispatch. Only the lookup holds the lock, so a
+        // subscriber may subscribe or unsubscribe
+        {
+          std::scoped_lock lock{ signals_mutex_ };
+          signals_.match(header, matched_signals_);
+        }
+        signal_router::deliver(header, matched_signals_);
         break;
       }
       case method_call: {
-        // todo implement
+        // served by the object_server of the socket, before they are queued
         break;
       }
       case invalid: {
@@ -106,44 +126,146 @@ public:
     return {};
   }
 
-  struct event {
-    protocol::header::header wait_header{};
-    condition_variable cv;
-    protocol::header::header recv_header{};
-    std::string message{};
-    std::error_code err{};
-  };
+  /// \brief Registers the call with serial as pending, must happen before the call is written since the reply may be
+  /// read before the write completes
+  void expect(std::uint32_t serial) {
+    std::scoped_lock lock{ mutex_ };
+    pending_replies_.insert(serial, {});
+  }
 
-  auto async_wait(is_header auto&& header,
-                  asio::completion_token_for<
-                      void(std::error_code, std::size_t, protocol::header::header const&, std::string_view)> auto&& token) {
-    auto exe{ asio::get_associated_executor(token) };
-    auto new_event{ std::make_shared<event>(header, condition_variable{ exe }) };
+  /// \brief Registers every call of serials as pending under a single lock
+  void expect_all(serial_block serials) {
     std::scoped_lock lock{ mutex_ };
-    message_queue_.emplace_back(new_event);
-    return asio::async_compose<decltype(token),
-                               void(std::error_code, std::size_t, protocol::header::header const&, std::string_view)>(
-        [first_call = true, new_event](auto& self, std::error_code err = {}) mutable {
-          if (first_call) {
-            first_call = false;
-            new_event->cv.async_wait(std::move(self));
-            return;
-          }
-          if (err) {
-            return self.complete(err, {}, {}, {});
+    for (std::uint32_t idx{}; idx < serials.size(); ++idx) {
+      pending_replies_.insert(serials[idx], {});
+    }
+  }
+
+  /// \brief Drops the pending call of serial, used when the call could not be written
+  void forget(std::uint32_t serial) {
+    std::scoped_lock lock{ mutex_ };
+    pending_replies_.erase(serial);
+  }
+
+  /// \brief Waits for the reply to the pending call of serial, completes right away if it already arrived
+  auto async_wait_reply(std::uint32_t serial,
+                        asio::completion_token_for<
+                            void(std::error_code, std::size_t, protocol::header::header_view, std::string_view)> auto&& token) {
+    return asio::async_initiate<decltype(token),
+                                void(std::error_code, std::size_t, protocol::header::header_view, std::string_view)>(
+        [this, serial](auto handler) {
+          auto exe{ asio::get_associated_executor(handler, executor_) };
+          auto alloc{ asio::get_associated_allocator(handler) };
+          deliver<decltype(handler)> function{ std::move(handler) };
+          std::unique_lock lock{ mutex_ };
+          auto* pending{ pending_replies_.find(serial) };
+          if (pending == nullptr || pending->reply) {
+            // either unknown or already arrived, complete outside of the initiation
+            std::optional<incoming_message> reply{};
+            if (pending != nullptr) {
+              reply = std::move(pending->reply);
+              pending_replies_.erase(serial);
+            }
+            lock.unlock();
+            reply_slot slot{};
+            slot.emplace(std::move(function), std::move(exe), alloc);
+            if (!reply) {
+              // todo custom error_code
+              return slot.post(std::make_error_code(std::errc::invalid_argument), incoming_message{});
+            }
+            return slot.post({}, std::move(*reply));
           }
-          self.complete(new_event->err, new_event->message.size(), new_event->recv_header, new_event->message);
+          pending->slot.emplace(std::move(function), std::move(exe), alloc);
         },
-        token, exe);
+        token);
+  }
+
+  /// \brief Calls callback for every signal matching rule which carries a body_t, see signal_router
+  template <typename body_t>
+  auto subscribe(protocol::match_rule rule,
+                 std::invocable<protocol::header::header_view const&, body_t const&> auto&& callback)
+      -> signal_router::subscription_id {
+    std::scoped_lock lock{ signals_mutex_ };
+    return signals_.subscribe<body_t>(std::move(rule), std::forward<decltype(callback)>(callback));
+  }
+
+  /// \brief Removes a subscription, returns its rule
+  auto unsubscribe(signal_router::subscription_id id) -> std::optional<protocol::match_rule> {
+    std::scoped_lock lock{ signals_mutex_ };
+    auto const* rule{ signals_.rule(id) };
+    if (rule == nullptr) {
+      return std::nullopt;
+    }
+    std::optional<protocol::match_rule> output{ *rule };
+    signals_.unsubscribe(id);
+    return output;
   }
 
 private:
-  std::vector<std::shared_ptr<event>> message_queue_;
+  using reply_slot = completion_slot<void(std::error_code, incoming_message)>;
+
+  // Adapts a handler of the views to the slot, the message is alive while the handler runs
+  template <typename handler_t>
+  struct deliver {
+    handler_t handler;
+
+    void operator()(std::error_code err, incoming_message message) {
+      if (err) {
+        return std::move(handler)(err, 0, protocol::header::header_view{}, std::string_view{});
+      }
+      auto const body{ message.header.body() };
+      std::move(handler)(err, body.size(), message.header, body);
+    }
+  };
+
+  struct pending_call {
+    reply_slot slot{};
+    // a reply read before anyone waits for it
+    std::optional<incoming_message> reply{};
+  };
+
+  auto on_reply(std::uint32_t reply_serial, incoming_message&& message) -> std::error_code {
+    reply_slot slot{};
+    {
+      std::scoped_lock lock{ mutex_ };
+      auto* pending{ pending_replies_.find(reply_serial) };
+      if (pending == nullptr) {
+        if (pending_replies_.empty()) {
+          // is this an error? don't think so
+          return {};
+        }
+        fmt::println(stderr, "error: serial {} not found", reply_serial);
+        // todo custom error_code
+        return std::make_error_code(std::errc::bad_message);
+      }
+      if (!pending->slot.has_handler()) {
+        pending->reply.emplace(std::move(message));
+        return {};
+      }
+      slot = std::move(pending->slot);
+      pending_replies_.erase(reply_serial);
+    }
+    // completed directly from the read loop, outside of the lock
+    slot.complete({}, std::move(message));
+    return {};
+  }
+
+  asio::any_io_executor executor_;
+  // calls waiting for their reply, by the serial of the call
+  serial_map<pending_call> pending_replies_;
   std::mutex mutex_;
+  // held while signals are matched, separate so a subscriber may call methods
+  signal_router signals_;
+  std::mutex signals_mutex_;
+  // reused by every signal, only touched by the read loop
+  signal_router::matches matched_signals_;
 };
 
 }  // namespace detail
 
+/// \brief A connection to a message bus
+/// \note By default everything runs on the thread of the io_context. To run a connection on several threads create it
+/// on a strand and serve calls on a sharded executor with dispatch_calls_on, see sharded_executor.
 template <typename Executor = asio::any_io_executor>
 class basic_dbus_socket {
 public:
@@ -153,17 +275,18 @@ public:
     requires std::same_as<std::remove_cvref_t<executor_in_t>, Executor>
   explicit basic_dbus_socket(executor_in_t&& executor) : socket_{ std::forward<executor_in_t>(executor) } {}
 
-  std::uint32_t new_serial() {
-    std::scoped_lock lock{ serial_mutex_ };
-    return ++serial_;
-  }
+  std::uint32_t new_serial() { return serials_.next(); }
+
+  /// \brief count serials in one step, for sending a batch of messages
+  serial_block reserve_serials(std::uint32_t count) { return serials_.reserve(count); }
 
   auto async_connect(auto&& endpoint, asio::completion_token_for<void(std::error_code)> auto&& token) {
     // https://dbus.freedesktop.org/doc/dbus-specification.html#auth-nul-byte
     enum struct state_e : std::uint8_t { connect, auth_nul_byte, complete };
-    using std::string_literals::operator""s;
+    // static storage, the state of the operation moves while the write is queued
+    static constexpr std::string_view nul_byte{ "\0", 1 };
     return asio::async_compose<decltype(token), void(std::error_code)>(
-        [this, state = state_e::connect, endp = std::forward<decltype(endpoint)>(endpoint), auth_buffer = "\0"s](
+        [this, state = state_e::connect, endp = std::forward<decltype(endpoint)>(endpoint)](
             auto& self, std::error_code err = {}, std::size_t size = 0) mutable -> void {
           if (err) {
             return self.complete(err);
@@ -175,7 +298,7 @@ public:
             }
             case state_e::auth_nul_byte: {
               state = state_e::complete;
-              return asio::async_write(socket_, asio::buffer(auth_buffer), std::move(self));
+              return writes_.async_write({ asio::buffer(nul_byte) }, std::move(self));
             }
             case state_e::complete: {
               return self.complete(err);
@@ -233,7 +356,7 @@ public:
           switch (state) {
             case state_e::send_auth: {
               state = state_e::recv_ack;
-              return asio::async_write(socket_, asio::buffer(*auth), std::move(self));
+              return writes_.async_write({ asio::buffer(*auth) }, std::move(self));
             }
             case state_e::recv_ack: {
               state = state_e::send_begin;
@@ -244,7 +367,7 @@ public:
               state = state_e::complete;
               recv_view = { recv_buffer->data(), size };
               if (recv_view.starts_with(ok_command) && recv_view.ends_with(line_ending)) {
-                return asio::async_write(socket_, asio::buffer(*begin), std::move(self));
+                return writes_.async_write({ asio::buffer(*begin) }, std::move(self));
               }
               return self.complete(std::make_error_code(std::errc::bad_message), recv_view);
             }
@@ -257,136 +380,169 @@ public:
   }
 
   /// \brief async read from socket returns when a error occurs, otherwise infinite loop
+  /// \note Reads large chunks into one reusable buffer and dispatches every complete message in it before reading again,
+  /// a read may end anywhere within a message
   auto async_read_loop(asio::completion_token_for<void(std::error_code)> auto&& token) {
-    enum struct state_e : std::uint8_t { recv_fixed_header, recv_header_fields, recv_payload, complete };
     return asio::async_compose<decltype(token), void(std::error_code)>(
-        [this, state{ state_e::recv_fixed_header }, buffer_header{ std::make_shared<std::string>() },
-         buffer_header_fields{ std::make_shared<std::string>() }, buffer_payload{ std::make_shared<std::string>() },
-         recv_header{ protocol::header::header{} }](auto& self, std::error_code err = {},
-                                                    std::size_t size = 0) mutable -> void {
+        [this, buffer{ std::make_shared<receive_buffer>() }](auto& self, std::error_code err = {},
+                                                             std::size_t size = 0) mutable -> void {
           if (err) {
             return self.complete(err);
           }
-          switch (state) {
-            case state_e::recv_fixed_header: {
-              state = state_e::recv_header_fields;
-              buffer_header = std::make_shared<std::string>();
-              buffer_header->resize(sizeof(protocol::header::fixed_header));
-              return socket_.async_read_some(asio::buffer(*buffer_header), std::move(self));
-            }
-            case state_e::recv_header_fields: {
-              state = state_e::recv_payload;
-              protocol::header::fixed_header fixed_header{};
-              auto deserialize_error{ protocol::read_dbus_binary(fixed_header, *buffer_header) };
-              if (!!deserialize_error) {
-                fmt::println(stderr, "error: {}\n", deserialize_error);
-                // todo std::error_code convertible
-                return self.complete(std::make_error_code(std::errc::bad_message));
-              }
-              // + padding length
-              const std::size_t total_header_length{ sizeof(protocol::header::fixed_header) +
-                                                     fixed_header.fields_array_len };
-              constexpr auto alignment{ 8 };  // 8 bit alignment after header
-              const auto padding = (alignment - (total_header_length % alignment)) % alignment;
-              buffer_header_fields = std::make_shared<std::string>();
-              buffer_header_fields->resize(fixed_header.fields_array_len + padding);
-              return socket_.async_read_some(asio::buffer(*buffer_header_fields), std::move(self));
-            }
-            case state_e::recv_payload: {
-              state = state_e::complete;
-              // not the most optimized but shouldn't be too big copy
-              buffer_header->append(*buffer_header_fields);
-              auto deserialize_error{ protocol::read_dbus_binary(recv_header, *buffer_header) };
-              if (!!deserialize_error) {
-                fmt::println(stderr, "error: {}\n", deserialize_error);
-                // todo std::error_code convertible
-                return self.complete(std::make_error_code(std::errc::bad_message));
-              }
-              buffer_payload = std::make_shared<std::string>();
-              buffer_payload->resize(recv_header.body_length);
-              return socket_.async_read_some(asio::buffer(*buffer_payload), std::move(self));
-            }
-            case state_e::complete: {
-              state = state_e::recv_fixed_header;  // loop
-              if (auto message_queue_err{ incoming_message_queue_.on_message(protocol::header::header{ recv_header },
-                                                                             std::move(*buffer_payload)) }) {
-                return self.complete(message_queue_err);
-              }
-              return asio::post(std::move(self));
-            }
+          if (auto consume_err{ consume(*buffer, size) }) {
+            return self.complete(consume_err);
           }
+          return socket_.async_read_some(buffer->free_space(), std::move(self));
         },
         token, socket_);
   }
 
+  /// \brief The read loop as a coroutine, the receive buffer lives in its frame
+  auto read_loop() -> asio::awaitable<std::error_code> {
+    receive_buffer buffer{};
+    std::size_t size{};
+    while (true) {
+      if (auto consume_err{ consume(buffer, size) }) {
+        co_return consume_err;
+      }
+      auto [err, read]{ co_await socket_.async_read_some(buffer.free_space(), asio::as_tuple(asio::use_awaitable)) };
+      if (err) {
+        co_return err;
+      }
+      size = read;
+    }
+  }
+
+  /// \note An lvalue params is referenced by the write and must outlive the operation, an rvalue is moved in
   template <typename return_type>
   auto call_method(is_header auto&& header,
                    auto&& params,
                    asio::completion_token_for<void(glz::expected<return_type, std::error_code>)> auto&& token) {
     using return_t = glz::expected<return_type, std::error_code>;
-    auto write_buffer = std::make_shared<std::vector<std::uint8_t>>();
-    adbus::protocol::error serialize_error{};
+    // Large payloads of params are referenced by the write buffer instead of copied, so both live until the write is done
+    auto write_buffer = protocol::make_outgoing_message(std::forward<decltype(params)>(params));
     header.serial = new_serial();
-    if constexpr (std::same_as<glz::skip, std::decay_t<decltype(params)>>) {
-      serialize_error = protocol::write_dbus_binary(header, *write_buffer);
-    } else {
-      serialize_error = protocol::write_dbus_binary(params, *write_buffer);
-      if (!serialize_error) {
-        std::vector<std::uint8_t> header_buffer{};
-        header.body_length = write_buffer->size();
-        serialize_error = protocol::write_dbus_binary(header, header_buffer);
-        if (!serialize_error) {
-          // todo benchmark insert vs push_back and rotate or even use std::deque
-          write_buffer->insert(write_buffer->begin(), header_buffer.begin(), header_buffer.end());
-        }
-      }
-    }
+    // header and body are written in one pass, body_length is filled in by the writer
+    adbus::protocol::error serialize_error{ protocol::write_dbus_message(header, write_buffer->params,
+                                                                         write_buffer->buffer) };
     enum struct state_e : std::uint8_t { send_write, wait_reply, complete };
     return asio::async_compose<decltype(token), void(return_t)>(
         [this, serialize_error, write_buffer{ std::move(write_buffer) }, state{ state_e::send_write },
-         header_mv{ std::move(header) }](auto& self, std::error_code err = {}, std::size_t size = 0,
-                                         protocol::header::header const& recv_header = {},
-                                         std::string_view reply = {}) mutable -> void {
+         serial{ header.serial }](auto& self, std::error_code err = {}, std::size_t size = 0,
+                                  protocol::header::header_view recv_header = {},
+                                  std::string_view reply = {}) mutable -> void {
           if (serialize_error) {
             fmt::println(stderr, "error: {}\n", serialize_error);
             // Todo make error as std::error_code
             return self.complete(glz::unexpected<std::error_code>(std::make_error_code(std::errc::no_message_available)));
           }
           if (err) {
+            if (state == state_e::wait_reply) {
+              // the write failed, no reply will come
+              incoming_message_queue_.forget(serial);
+            }
             return self.complete(glz::unexpected<std::error_code>(err));
           }
           switch (state) {
             case state_e::send_write: {
               state = state_e::wait_reply;
-              return asio::async_write(socket_, asio::buffer(*write_buffer), std::move(self));
+              // The reply may be read before the write completes, so the call is registered before anything is written.
+              // This runs in the initiation, an operation which is never launched, e.g. deferred, registers nothing.
+              incoming_message_queue_.expect(serial);
+              // one gathered write of the framing and the referenced payloads
+              std::vector<asio::const_buffer> buffers{};
+              append_buffers(buffers, write_buffer->buffer);
+              return writes_.async_write(std::move(buffers), std::move(self));
             }
             case state_e::wait_reply: {
               state = state_e::complete;
-              // todo now we have written to the socket, I hope that we don't receive the reply before the below is done
-              // can we somehow mutex it or are we confident it won't occur?
-              return incoming_message_queue_.async_wait(std::move(header_mv), std::move(self));
+              return incoming_message_queue_.async_wait_reply(serial, std::move(self));
             }
             case state_e::complete: {
-              if (recv_header.signature() != protocol::type::signature_v<return_type>) {
-                fmt::println(stderr, "error: expected signature {} got {}\n", protocol::type::signature_v<return_type>,
-                             recv_header.signature().value_or("unknown"));
-                // todo std::error_code convertible
-                return self.complete(glz::unexpected<std::error_code>(std::make_error_code(std::errc::bad_message)));
-              }
-              return_type return_value{};
-              auto parse_error{ protocol::read_dbus_binary(return_value, reply) };
-              if (!!parse_error) {
-                fmt::println(stderr, "error: {}\n", parse_error);
-                // todo std::error_code convertible
-                return self.complete(glz::unexpected<std::error_code>(std::make_error_code(std::errc::bad_message)));
-              }
-              return self.complete(std::move(return_value));
+              return self.complete(parse_reply<return_type>(recv_header, reply));
             }
           }
         },
         token, socket_);
   }
 
+  /// \brief Pipelines a batch of calls, all of them are written at once and completes with every reply
+  /// \param calls pairs of a header and the parameters of the call, the serial of each header is assigned here
+  /// \note The waiters of all calls are registered before anything is written and the serialized calls are sent in one
+  /// gathered write, so the batch costs a single round trip. The replies may arrive in any order, the results are in
+  /// the order of calls.
+  template <typename return_type, is_header header_t, typename params_t>
+  auto call_methods(std::vector<std::pair<header_t, params_t>> calls,
+                    asio::completion_token_for<void(std::vector<glz::expected<return_type, std::error_code>>)> auto&& token) {
+    using return_t = glz::expected<return_type, std::error_code>;
+    return asio::async_initiate<decltype(token), void(std::vector<return_t>)>(
+        [this](auto handler, std::vector<std::pair<header_t, params_t>> calls_mv) {
+          using handler_t = decltype(handler);
+          struct batch {
+            std::vector<std::pair<header_t, params_t>> calls;
+            // one buffer per call, every message is aligned from its own beginning
+            std::vector<protocol::gather_buffer> buffers;
+            std::vector<return_t> results;
+            // replies may complete on several threads when the handler's executor is a pool
+            std::atomic<std::size_t> remaining;
+            handler_t handler;
+
+            // posted, finish is also reached from the initiation when nothing could be written
+            void finish() {
+              auto exe{ asio::get_associated_executor(handler) };
+              asio::post(exe, [handler_mv{ std::move(handler) }, results_mv{ std::move(results) }]() mutable {
+                std::move(handler_mv)(std::move(results_mv));
+              });
+            }
+          };
+          auto const count{ calls_mv.size() };
+          auto state{ std::make_shared<batch>(std::move(calls_mv), std::vector<protocol::gather_buffer>(count),
+                                              std::vector<return_t>(count), count, std::move(handler)) };
+          if (count == 0) {
+            return state->finish();
+          }
+
+          auto const serials{ reserve_serials(static_cast<std::uint32_t>(count)) };
+          std::vector<asio::const_buffer> buffers{};
+          for (std::size_t idx{}; idx < count; ++idx) {
+            auto& [header, params]{ state->calls[idx] };
+            header.serial = serials[idx];
+            if (auto err{ protocol::write_dbus_message(header, params, state->buffers[idx]) }) {
+              fmt::println(stderr, "error: {}\n", err);
+              // Todo make error as std::error_code
+              state->results.assign(count, glz::unexpected(std::make_error_code(std::errc::no_message_available)));
+              return state->finish();
+            }
+            append_buffers(buffers, state->buffers[idx]);
+          }
+
+          incoming_message_queue_.expect_all(serials);
+          writes_.async_write(std::move(buffers), [this, state, serials](std::error_code err, std::size_t) {
+            if (err) {
+              for (std::uint32_t idx{}; idx < serials.size(); ++idx) {
+                incoming_message_queue_.forget(serials[idx]);
+              }
+              state->results.assign(state->results.size(), glz::unexpected(err));
+              return state->finish();
+            }
+            auto const exe{ asio::get_associated_executor(state->handler, socket_.get_executor()) };
+            for (std::uint32_t idx{}; idx < serials.size(); ++idx) {
+              incoming_message_queue_.async_wait_reply(
+                  serials[idx],
+                  asio::bind_executor(exe, [state, idx](std::error_code wait_err, std::size_t,
+                                                        protocol::header::header_view recv_header, std::string_view reply) {
+                    state->results[idx] =
+                        wait_err ? return_t{ glz::unexpected(wait_err) } : parse_reply<return_type>(recv_header, reply);
+                    if (--state->remaining == 0) {
+                      state->finish();
+                    }
+                  }));
+            }
+          });
+        },
+        token, std::move(calls));
+  }
+
   template <typename return_type>
   auto call_method(is_header auto&& header,
                    asio::completion_token_for<void(glz::expected<return_type, std::error_code>)> auto&& token) {
@@ -398,84 +554,282 @@ public:
     return call_method<std::string_view>(protocol::methods::hello(), std::forward<decltype(token)>(token));
   }
 
+  /// \note params must outlive the operation
   auto request_name(api::request_name_params const& params,
                     asio::completion_token_for<void(glz::expected<api::request_name_reply, std::error_code>)> auto&& token) {
     return call_method<api::request_name_reply>(protocol::methods::request_name(), params,
                                                 std::forward<decltype(token)>(token));
   }
 
-  template <typename method_param_t, typename method_result_t = void>
-  auto register_method(is_header auto&& header,
-                       std::invocable<method_result_t(glz::expected<method_param_t, std::error_code>)> auto&& token) {
-    enum struct state_e : std::uint8_t { wait_call, call };
-    auto exe{ asio::get_associated_executor(token) };
-    return asio::async_compose<decltype(token), method_result_t(protocol::header::header const&, glz::expected<method_param_t, std::error_code>)>(
-        [this, state{ state_e::wait_call }, header_mv{ std::forward<decltype(header)>(header) }](
-            auto& self, std::error_code err = {}, std::size_t size = 0, protocol::header::header const& recv_header = {},
-            std::string_view reply = {}) mutable {
-          if (err) {
-            return self.complete(glz::unexpected<std::error_code>(err));
+  /// \brief Calls a method from a coroutine, the serialized call lives in the coroutine frame
+  /// \note The waiter is registered before the call is written, like call_method. Views in the result refer to the
+  /// reply and stay valid until the calling coroutine next suspends, prefer owning types such as std::string.
+  template <typename return_type>
+  auto call(protocol::header::header header, auto params) -> asio::awaitable<glz::expected<return_type, std::error_code>> {
+    protocol::gather_buffer buffer{};
+    header.serial = new_serial();
+    if (auto serialize_error{ protocol::write_dbus_message(header, params, buffer) }) {
+      fmt::println(stderr, "error: {}\n", serialize_error);
+      // Todo make error as std::error_code
+      co_return glz::unexpected(std::make_error_code(std::errc::no_message_available));
+    }
+    incoming_message_queue_.expect(header.serial);
+    std::vector<asio::const_buffer> buffers{};
+    append_buffers(buffers, buffer);
+    if (auto [err, written]{ co_await writes_.async_write(std::move(buffers), asio::as_tuple(asio::use_awaitable)) };
+        err) {
+      incoming_message_queue_.forget(header.serial);
+      co_return glz::unexpected(std::error_code{ err });
+    }
+    // resumed from the read loop, the reply is alive until this coroutine suspends again
+    auto [err, size, recv_header, reply]{ co_await incoming_message_queue_.async_wait_reply(
+        header.serial, asio::as_tuple(asio::use_awaitable)) };
+    if (err) {
+      co_return glz::unexpected(err);
+    }
+    co_return parse_reply<return_type>(recv_header, reply);
+  }
+
+  template <typename return_type>
+  auto call(protocol::header::header header) -> asio::awaitable<glz::expected<return_type, std::error_code>> {
+    return call<return_type>(std::move(header), glz::skip{});
+  }
+
+  /// \brief org.freedesktop.DBus.Hello from a coroutine, returns the unique name of the connection
+  auto hello() -> asio::awaitable<glz::expected<std::string, std::error_code>> {
+    return call<std::string>(protocol::methods::hello());
+  }
+
+  auto request_name(api::request_name_params params)
+      -> asio::awaitable<glz::expected<api::request_name_reply, std::error_code>> {
+    return call<api::request_name_reply>(protocol::methods::request_name(), params);
+  }
+
+  /// \brief Subscribes callback to the signals matching rule and asks the bus to route them to this connection
+  /// \note callback runs on the read loop while the subscriptions are locked, it must not add or remove matches itself
+  template <typename body_t>
+  auto add_match(
+      protocol::match_rule rule,
+      std::invocable<protocol::header::header_view const&, body_t const&> auto&& callback,
+      asio::completion_token_for<void(glz::expected<signal_router::subscription_id, std::error_code>)> auto&& token) {
+    using return_t = glz::expected<signal_router::subscription_id, std::error_code>;
+    auto rule_string{ rule.to_string() };
+    // subscribed before the bus is asked, so no signal routed in between is missed
+    auto const id{ incoming_message_queue_.subscribe<body_t>(std::move(rule),
+                                                             std::forward<decltype(callback)>(callback)) };
+    return asio::async_compose<decltype(token), void(return_t)>(
+        [this, id, rule_string{ std::move(rule_string) }, first_call = true](
+            auto& self, glz::expected<void, std::error_code> reply = {}) mutable -> void {
+          if (first_call) {
+            first_call = false;
+            return call_method<void>(protocol::methods::add_match(), std::move(rule_string), std::move(self));
           }
-          switch (state) {
-            case state_e::wait_call: {
-              state = state_e::call;
-              return incoming_message_queue_.async_wait(std::move(header_mv), std::move(self));
-            }
-            case state_e::call: {
-              if (recv_header.signature() != protocol::type::signature_v<method_param_t>) {
-                fmt::println(stderr, "error: expected signature {} got {}\n", protocol::type::signature_v<method_param_t>,
-                             recv_header.signature().value_or("unknown"));
-                // todo std::error_code convertible
-                // todo we should async_write error to header
-                return self.complete({}, glz::unexpected<std::error_code>(std::make_error_code(std::errc::bad_message)));
-              }
-              method_param_t param{};
-              auto parse_error{ protocol::read_dbus_binary(param, reply) };
-              if (!!parse_error) {
-                fmt::println(stderr, "error: {}\n", parse_error);
-                // todo std::error_code convertible
-                return self.complete({}, glz::unexpected<std::error_code>(std::make_error_code(std::errc::bad_message)));
-              }
-              return self.complete(recv_header, param);
-            }
+          if (!reply) {
+            incoming_message_queue_.unsubscribe(id);
+            return self.complete(glz::unexpected(reply.error()));
           }
-        }, [executor{ std::move(exe) }, invocable{ token }](protocol::header::header const& recv_header, glz::expected<method_param_t, std::error_code> const& params) mutable {
-          if constexpr (has_co_await<method_result_t>) {
-            asio::co_spawn(executor, [this, invocable_mv{ std::move(invocable) }, recv_header_cp{ recv_header }, params_cp{ params }, write_buffer{ std::make_shared<std::string>() }]() -> asio::awaitable<void> {
-              auto result = co_await invocable_mv(params_cp);
-              auto err{ protocol::write_dbus_binary(result, *write_buffer) };
-              if (!!err) {
-                fmt::println(stderr, "error: {}\n", err);
-                // todo send write error in header
-                co_return;
-              }
-              protocol::header::header reply_header{
-                .type = protocol::header::message_type_e::method_return,
-                .body_length = write_buffer->size(),
-                .serial = new_serial(),
-                .fields = {
-                  protocol::header::field_reply_serial{ recv_header_cp.serial }
-                  // todo more fields such as destination
-                }
-              };
-
-              // todo async write result
-            }, asio::detached);
+          return self.complete(id);
+        },
+        token, socket_);
+  }
+
+  /// \brief Removes a subscription made by add_match, locally and on the bus
+  auto remove_match(signal_router::subscription_id id,
+                    asio::completion_token_for<void(glz::expected<void, std::error_code>)> auto&& token) {
+    auto rule{ incoming_message_queue_.unsubscribe(id) };
+    return asio::async_compose<decltype(token), void(glz::expected<void, std::error_code>)>(
+        [this, rule{ std::move(rule) }, first_call = true](auto& self,
+                                                          glz::expected<void, std::error_code> reply = {}) mutable -> void {
+          if (first_call) {
+            first_call = false;
+            if (!rule) {
+              // not completed from within the initiation
+              return asio::post(std::move(self));
+            }
+            return call_method<void>(protocol::methods::remove_match(), rule->to_string(), std::move(self));
           }
-          else {
-            auto result = invocable(params);
-            // todo async write result
+          if (!rule) {
+            // todo custom error_code
+            return self.complete(glz::unexpected(std::make_error_code(std::errc::invalid_argument)));
           }
+          return self.complete(std::move(reply));
+        },
+        token, socket_);
+  }
 
-        }, socket_);
+  /// \brief Serves method calls on shards of executor, by the hash of their object path, instead of on the read loop
+  /// \note See sharded_executor for the threading model. To be called before the read loop is started.
+  void dispatch_calls_on(asio::any_io_executor const& executor, std::size_t shards) { workers_.emplace(executor, shards); }
+
+  /// \brief Serves member of interface at path, calls are dispatched from the read loop or the shard of path
+  /// \param handler a handler as accepted by object_server::add_method, or method_result_t(method_param_t const&)
+  /// returning an awaitable which is spawned on the executor the calls of path are dispatched on
+  /// \return false when the method is already served
+  template <typename method_param_t, typename method_result_t>
+  auto register_method(std::string_view path, std::string_view interface, std::string_view member, auto&& handler)
+      -> bool {
+    using handler_t = std::decay_t<decltype(handler)>;
+    if constexpr (!std::is_void_v<method_param_t> && std::invocable<handler_t&, method_param_t const&> &&
+                  detail::is_awaitable<std::invoke_result_t<handler_t&, method_param_t const&>>::value) {
+      // shared with the running coroutines, the method may be unregistered while they run
+      auto shared_handler{ std::make_shared<handler_t>(std::forward<decltype(handler)>(handler)) };
+      return objects_.add_method<method_param_t, method_result_t>(
+          path, interface, member,
+          [this, shared_handler, path_cp = std::string{ path }](method_param_t const& params,
+                                                                 object_server::responder to) {
+            // the call is gone once this returns, the coroutine keeps a copy of params
+            asio::co_spawn(
+                executor_of(path_cp),
+                [shared_handler, params_cp = params, to_mv = std::move(to)]() mutable -> asio::awaitable<void> {
+                  if constexpr (std::is_void_v<method_result_t>) {
+                    co_await (*shared_handler)(params_cp);
+                    to_mv.reply();
+                  } else {
+                    to_mv.reply(co_await (*shared_handler)(params_cp));
+                  }
+                },
+                asio::detached);
+          });
+    } else {
+      return objects_.add_method<method_param_t, method_result_t>(path, interface, member,
+                                                                  std::forward<decltype(handler)>(handler));
+    }
+  }
+
+  auto unregister_method(std::string_view path, std::string_view interface, std::string_view member) -> bool {
+    return objects_.remove_method(path, interface, member);
   }
 
 private:
+  // Received bytes, data()[begin, end) is the start of the messages not consumed yet
+  struct receive_buffer {
+    // Reads ask for at least this much so many small messages are received with a single syscall
+    static constexpr std::size_t read_chunk_size{ 64 * 1024 };
+
+    [[nodiscard]] auto free_space() -> asio::mutable_buffer { return asio::buffer(data.data() + end, data.size() - end); }
+
+    std::string data{};
+    std::size_t begin{};
+    std::size_t end{};
+  };
+
+  // Hands every complete message of the received bytes to its consumer, then makes room for the next read
+  auto consume(receive_buffer& buffer, std::size_t received) -> std::error_code {
+    buffer.end += received;
+    std::size_t wanted{ protocol::header::header_view::fixed_size };
+    while (true) {
+      std::string_view const pending{ buffer.data.data() + buffer.begin, buffer.end - buffer.begin };
+      auto const message_size{ protocol::header::header_view::peek_message_size(pending) };
+      if (message_size && *message_size > protocol::max_message_length) [[unlikely]] {
+        fmt::println(stderr, "error: message of {} bytes exceeds the maximum length\n", *message_size);
+        return std::make_error_code(std::errc::message_size);
+      }
+      if (!message_size || pending.size() < *message_size) {
+        wanted = message_size.value_or(protocol::header::header_view::fixed_size);
+        break;
+      }
+      auto view{ protocol::header::header_view::make(pending.substr(0, *message_size)) };
+      buffer.begin += *message_size;
+      if (!view) {
+        fmt::println(stderr, "error: {}\n", view.error());
+        // todo std::error_code convertible
+        return std::make_error_code(std::errc::bad_message);
+      }
+      if (view->type() == protocol::header::message_type_e::method_call) {
+        if (workers_) {
+          // the call outlives the receive buffer once it is queued on its shard
+          workers_->post(view->path().value_or(""),
+                         [this, call = detail::incoming_message{ *view, std::string{ view->data() } }]() {
+                           objects_.dispatch(call.header);
+                         });
+          continue;
+        }
+        // the handler decodes the call before dispatch returns, so it is served from the receive buffer
+        objects_.dispatch(*view);
+        continue;
+      }
+      // The message is copied out as the queue takes ownership of it, the receive buffer is reused
+      std::string message{ view->data() };
+      if (auto message_queue_err{ incoming_message_queue_.on_message(*view, std::move(message)) }) {
+        return message_queue_err;
+      }
+    }
+    // Move the incomplete message to the front and make room for at least the rest of it
+    if (buffer.begin > 0) {
+      std::memmove(buffer.data.data(), buffer.data.data() + buffer.begin, buffer.end - buffer.begin);
+      buffer.end -= buffer.begin;
+      buffer.begin = 0;
+    }
+    auto const size{ (std::max)(wanted, buffer.end + receive_buffer::read_chunk_size) };
+    if (buffer.data.size() < size) {
+      buffer.data.resize(size);
+    }
+    return {};
+  }
+
+  // Writes a message which is not awaited, e.g. a reply of the object server
+  void send(buffer_pool::buffer&& message) {
+    // the bytes of a small string move with it, the buffer is kept at a stable address until written
+    auto owned{ std::make_shared<buffer_pool::buffer>(std::move(message)) };
+    // a reply may be sent from a worker, the queue hands it over to the executor of the socket
+    writes_.async_write({ asio::buffer(owned->view()) }, [owned](std::error_code err, std::size_t) {
+      if (err) {
+        fmt::println(stderr, "error: {}\n", err.message());
+      }
+    });
+  }
+
+  // Where the calls to objects at path are served
+  auto executor_of(std::string_view path) -> asio::any_io_executor {
+    if (workers_) {
+      return workers_->shard_of(path);
+    }
+    return socket_.get_executor();
+  }
+
+  static void append_buffers(std::vector<asio::const_buffer>& output, protocol::gather_buffer const& buffer) {
+    for (auto const& segment : buffer.buffers()) {
+      output.emplace_back(segment.data(), segment.size());
+    }
+  }
+
+  template <typename return_type>
+  static auto parse_reply(protocol::header::header_view const& recv_header, std::string_view reply)
+      -> glz::expected<return_type, std::error_code> {
+    if constexpr (std::is_void_v<return_type>) {
+      if (!recv_header.signature().value_or("").empty()) {
+        fmt::println(stderr, "error: expected no body got {}\n", *recv_header.signature());
+        // todo std::error_code convertible
+        return glz::unexpected<std::error_code>(std::make_error_code(std::errc::bad_message));
+      }
+      return {};
+    } else {
+      if (recv_header.signature() != protocol::type::signature_v<return_type>) {
+        fmt::println(stderr, "error: expected signature {} got {}\n", protocol::type::signature_v<return_type>,
+                     recv_header.signature().value_or("unknown"));
+        // todo std::error_code convertible
+        return glz::unexpected<std::error_code>(std::make_error_code(std::errc::bad_message));
+      }
+      return_type return_value{};
+      auto parse_error{ protocol::read_dbus_binary(return_value, reply, recv_header.byte_order()) };
+      if (!!parse_error) {
+        fmt::println(stderr, "error: {}\n", parse_error);
+        // todo std::error_code convertible
+        return glz::unexpected<std::error_code>(std::make_error_code(std::errc::bad_message));
+      }
+      return return_value;
+    }
+  }
+
   // todo windows using generic::stream_protocol::socket
-  std::uint32_t serial_{};
-  std::mutex serial_mutex_{};
+  serial_counter serials_{};
   asio::local::stream_protocol::socket socket_;
-  detail::incoming_message_queue incoming_message_queue_{};
+  // every message is written through the queue, concurrent writes would interleave on the socket
+  write_queue<asio::local::stream_protocol::socket> writes_{ socket_ };
+  detail::incoming_message_queue incoming_message_queue_{ socket_.get_executor() };
+  object_server objects_{ serials_, [this](buffer_pool::buffer&& reply) { send(std::move(reply)); } };
+  // set when calls are served off the read loop
+  std::optional<sharded_executor<>> workers_{};
 };
 
 template <typename Executor>
@@ -524,22 +878,26 @@ int main() {
       if (err) {
         return;
       }
-      socket.async_read_loop([&](auto&& ec) { fmt::println("read_loop err: {}\n", ec.message()); });
-      socket.say_hello([&](glz::expected<std::string_view, std::error_code> id) {
-        if (id) {
-          fmt::println("say_hello: {}\n", *id);
-          socket.request_name({ .name = "com.example.HelloWorld" },
-                              [&](glz::expected<adbus::api::request_name_reply, std::error_code> reply) {
-                                if (reply) {
-                                  fmt::println("request_name: {}\n", std::to_underlying(*reply));
-                                } else {
-                                  fmt::println("request_name error: {}\n", reply.error().message());
-                                }
-                              });
-        } else {
-          fmt::println("say_hello error: {}\n", id.error().message());
-        }
+      asio::co_spawn(ctx, socket.read_loop(), [](std::exception_ptr, std::error_code read_err) {
+        fmt::println("read_loop err: {}\n", read_err.message());
       });
+      asio::co_spawn(
+          ctx,
+          [&]() -> asio::awaitable<void> {
+            auto id{ co_await socket.hello() };
+            if (!id) {
+              fmt::println("hello error: {}\n", id.error().message());
+              co_return;
+            }
+            fmt::println("hello: {}\n", *id);
+            auto reply{ co_await socket.request_name({ .name = "com.example.HelloWorld" }) };
+            if (reply) {
+              fmt::println("request_name: {}\n", std::to_underlying(*reply));
+            } else {
+              fmt::println("request_name error: {}\n", reply.error().message());
+            }
+          },
+          asio::detached);
     });
   });
 
@@ -0,0 +1,93 @@
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include <boost/ut.hpp>
+
+#include <adbus/util/byteswap.hpp>
+#include <adbus/util/simd.hpp>
+
+using namespace boost::ut;
+
+namespace {
+
+// The bytes of count elements of size bytes each, each element reversed
+auto reversed(std::vector<unsigned char> const& input, std::size_t size) -> std::vector<unsigned char> {
+  std::vector<unsigned char> output(input.size());
+  for (std::size_t idx{}; idx < input.size(); ++idx) {
+    output[idx] = input[idx / size * size + (size - 1 - idx % size)];
+  }
+  return output;
+}
+
+// Checks swap against the reference for every count up to a few blocks of 32 bytes, from unaligned addresses as well
+template <std::size_t size>
+void check(auto swap, std::string_view path) {
+  for (std::size_t count{}; count < 3 * 32 / size + 3; ++count) {
+    for (std::size_t offset{}; offset < 3; ++offset) {
+      std::vector<unsigned char> input(count * size);
+      for (std::size_t idx{}; idx < input.size(); ++idx) {
+        input[idx] = static_cast<unsigned char>(idx * 7 + count);
+      }
+      std::vector<unsigned char> storage(offset + input.size() + 1, 0xaa);
+      std::ranges::copy(input, storage.begin() + static_cast<std::ptrdiff_t>(offset));
+      std::vector<unsigned char> output(offset + input.size() + 1, 0x55);
+      swap(output.data() + offset, storage.data() + offset, input.size());
+      std::vector<unsigned char> const swapped(output.begin() + static_cast<std::ptrdiff_t>(offset),
+                                               output.end() - 1);
+      expect(swapped == reversed(input, size)) << fmt::format("{} size {} count {} offset {}", path, size, count, offset);
+      // nothing is written past the end
+      expect(output.back() == 0x55);
+    }
+  }
+}
+
+template <std::size_t size>
+void check_all() {
+  namespace detail = adbus::util::detail;
+  check<size>([](unsigned char* out, unsigned char const* in, std::size_t bytes) {
+    adbus::util::byteswap_copy<size>(out, in, bytes / size);
+  }, "byteswap_copy");
+  check<size>([](unsigned char* out, unsigned char const* in, std::size_t bytes) {
+    detail::byteswap_scalar<size>(out, in, bytes);
+  }, "scalar");
+#if defined(ADBUS_SIMD_DISPATCH)
+  // the vector paths swap whole blocks, the rest is left to the scalar one
+  auto const level{ adbus::util::supported_simd() };
+  if (level >= adbus::util::simd_level::ssse3) {
+    check<size>([](unsigned char* out, unsigned char const* in, std::size_t bytes) {
+      auto const done{ detail::byteswap_ssse3<size>(out, in, bytes) };
+      expect(done == bytes / 16 * 16);
+      detail::byteswap_scalar<size>(out + done, in + done, bytes - done);
+    }, "ssse3");
+  }
+  if (level >= adbus::util::simd_level::avx2) {
+    check<size>([](unsigned char* out, unsigned char const* in, std::size_t bytes) {
+      auto const done{ detail::byteswap_avx2<size>(out, in, bytes) };
+      expect(done == bytes / 32 * 32);
+      detail::byteswap_scalar<size>(out + done, in + done, bytes - done);
+    }, "avx2");
+  }
+#endif
+}
+
+}  // namespace
+
+int main() {
+  "byteswap"_test = [] {
+    expect(adbus::util::byteswap(std::uint16_t{ 0x0102 }) == 0x0201_u);
+    expect(adbus::util::byteswap(std::uint32_t{ 0x01020304 }) == 0x04030201_u);
+    expect(adbus::util::byteswap(-1.5) == std::bit_cast<double>(std::byteswap(std::bit_cast<std::uint64_t>(-1.5))));
+  };
+
+  "every code path swaps every element"_test = [] {
+    check_all<2>();
+    check_all<4>();
+    check_all<8>();
+  };
+}
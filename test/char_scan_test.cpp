@@ -0,0 +1,121 @@
+#include <cstddef>
+#include <random>
+#include <string>
+#include <string_view>
+
+#include <fmt/format.h>
+
+#include <boost/ut.hpp>
+
+#include <adbus/protocol/char_scan.hpp>
+#include <adbus/protocol/name.hpp>
+#include <adbus/protocol/path.hpp>
+
+using namespace boost::ut;
+namespace protocol = adbus::protocol;
+using protocol::error, protocol::error_code;
+using protocol::detail::char_scan, protocol::detail::scan_chars, protocol::detail::scan_chars_scalar,
+    protocol::detail::scan_chars_simd;
+using adbus::util::simd_level;
+
+// The scalar scan in constant evaluation
+static_assert(scan_chars<'/', true>("/a//b.c", 1) == char_scan{ .invalid = 5, .doubled = 3 });
+static_assert(scan_chars<'/', true>("/a.b//c", 1) == char_scan{ .invalid = 2 });
+static_assert(scan_chars<'.', false>("a.b", 1) == char_scan{ .invalid = 1 });
+
+// Mostly word characters so the blocks hold separators, doubled separators and the odd invalid character at any lane
+auto random_input(std::mt19937& rng, std::size_t length) -> std::string {
+  static constexpr std::string_view alphabet{ "abcXYZ019_/.-\x80\xff " };
+  std::uniform_int_distribution<std::size_t> kind{ 0, 63 };
+  std::uniform_int_distribution<std::size_t> any{ 0, alphabet.size() - 1 };
+  std::string output(length, 'a');
+  for (auto& c : output) {
+    auto const roll{ kind(rng) };
+    c = roll < 8 ? '/' : roll < 10 ? alphabet[any(rng)] : alphabet[roll % 10];
+  }
+  return output;
+}
+
+int main() {
+  "same result as the scalar scan"_test = [] {
+    std::mt19937 rng{ 1337 };
+    for (std::size_t length{ 2 }; length < 100; ++length) {
+      for (int round{}; round < 200; ++round) {
+        auto const input{ random_input(rng, length) };
+        auto const from{ std::uniform_int_distribution<std::size_t>{ 1, length - 1 }(rng) };
+        expect(scan_chars<'/', true>(input, from) == scan_chars_scalar<'/', true>(input, from))
+            << fmt::format("input: {} from: {}", input, from);
+        expect(scan_chars<'.', false>(input, from) == scan_chars_scalar<'.', false>(input, from))
+            << fmt::format("input: {} from: {}", input, from);
+      }
+    }
+  };
+
+  "same result on every code path the cpu supports"_test = [] {
+    std::mt19937 rng{ 42 };
+    for (auto const level : { simd_level::none, simd_level::avx2 }) {
+      if (level > adbus::util::supported_simd()) {
+        continue;
+      }
+      for (std::size_t length{ 2 }; length < 100; ++length) {
+        for (int round{}; round < 50; ++round) {
+          auto const input{ random_input(rng, length) };
+          auto const from{ std::uniform_int_distribution<std::size_t>{ 1, length - 1 }(rng) };
+          expect(scan_chars_simd<'/', true>(input, from, level) == scan_chars_scalar<'/', true>(input, from))
+              << fmt::format("level: {} input: {} from: {}", static_cast<int>(level), input, from);
+          expect(scan_chars_simd<'.', false>(input, from, level) == scan_chars_scalar<'.', false>(input, from))
+              << fmt::format("level: {} input: {} from: {}", static_cast<int>(level), input, from);
+        }
+      }
+    }
+  };
+
+  "index of the error in long paths"_test = [] {
+    std::string const prefix{ "/org/freedesktop/DBus/some/long/enough/path/for/whole/blocks" };
+    expect(protocol::path::validate(prefix) == error{});
+    for (std::size_t idx{ 1 }; idx < prefix.size() - 1; ++idx) {
+      auto input{ prefix };
+      input[idx] = '-';
+      expect(protocol::path::validate(input) == error{ .code = error_code::invalid_character, .index = idx })
+          << fmt::format("input: {}", input);
+      input[idx] = '/';
+      if (prefix[idx - 1] == '/' || prefix[idx + 1] == '/') {
+        auto const doubled{ prefix[idx - 1] == '/' ? idx : idx + 1 };
+        expect(protocol::path::validate(input) == error{ .code = error_code::multiple_slashes, .index = doubled })
+            << fmt::format("input: {}", input);
+      }
+    }
+    // the first problem wins
+    expect(protocol::path::validate(prefix + "//a.b") ==
+           error{ .code = error_code::multiple_slashes, .index = prefix.size() + 1 });
+    expect(protocol::path::validate(prefix + ".b//a") ==
+           error{ .code = error_code::invalid_character, .index = prefix.size() });
+  };
+
+  "index of the error in long names"_test = [] {
+    std::string const interface{ "org.freedesktop.DBus.Some.Long.Enough.Interface.For.Whole.Blocks" };
+    expect(protocol::interface_name::validate(interface) == error{});
+    expect(protocol::bus_name::validate(":1.42." + interface) == error{});
+    for (std::size_t idx{ 1 }; idx < interface.size() - 1; ++idx) {
+      auto input{ interface };
+      input[idx] = '-';
+      expect(protocol::interface_name::validate(input) == error{ .code = error_code::invalid_character, .index = idx })
+          << fmt::format("input: {}", input);
+      expect(protocol::bus_name::validate(input) == error{ .code = error_code::invalid_character, .index = idx })
+          << fmt::format("input: {}", input);
+    }
+    // invalid characters come before doubled dots wherever they are
+    expect(protocol::interface_name::validate(interface + "..a-b") ==
+           error{ .code = error_code::invalid_character, .index = interface.size() + 3 });
+    expect(protocol::interface_name::validate(interface + "..ab") ==
+           error{ .code = error_code::multiple_dots, .index = interface.size() + 1 });
+    expect(protocol::interface_name::validate(interface + "..ab.") ==
+           error{ .code = error_code::trailing_dot, .index = interface.size() + 4 });
+
+    std::string const member{ "AMemberNameLongEnoughForWholeBlocksOfCharacters" };
+    expect(protocol::member_name::validate(member) == error{});
+    expect(protocol::member_name::validate(member + ".x") ==
+           error{ .code = error_code::invalid_character, .index = member.size() });
+    expect(protocol::member_name::validate("9" + member) == error{ .code = error_code::invalid_character, .index = 0 });
+  };
+}
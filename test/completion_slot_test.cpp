@@ -0,0 +1,125 @@
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <system_error>
+
+#include <boost/asio.hpp>
+#include <boost/ut.hpp>
+
+#include <adbus/core/completion_slot.hpp>
+#include <adbus/core/serial_map.hpp>
+
+using namespace boost::ut;
+namespace asio = boost::asio;
+
+namespace {
+
+std::size_t allocations{};
+
+template <typename T>
+struct counting_allocator {
+  using value_type = T;
+  counting_allocator() = default;
+  template <typename U>
+  counting_allocator(counting_allocator<U> const&) noexcept {}
+  auto allocate(std::size_t n) -> T* {
+    ++allocations;
+    return std::allocator<T>{}.allocate(n);
+  }
+  void deallocate(T* ptr, std::size_t n) noexcept { std::allocator<T>{}.deallocate(ptr, n); }
+  auto operator==(counting_allocator const&) const -> bool = default;
+};
+
+struct counting_handler {
+  using allocator_type = counting_allocator<void>;
+  std::size_t* received{};
+  [[nodiscard]] auto get_allocator() const noexcept -> allocator_type { return {}; }
+  void operator()(std::error_code, std::string message) const { *received = message.size(); }
+};
+
+}  // namespace
+
+int main() {
+  using slot_t = adbus::completion_slot<void(std::error_code, std::string)>;
+
+  "complete on the executor of the handler"_test = [] {
+    asio::io_context ctx{};
+    slot_t slot{};
+    std::size_t received{};
+    slot.emplace([&](std::error_code err, std::string message) { received = err ? 0 : message.size(); },
+                 ctx.get_executor());
+    expect(slot.has_handler());
+    slot.complete({}, std::string(100, 'x'));
+    expect(!slot.has_handler());
+    // not running on the io_context, so the handler is not invoked inline
+    expect(received == 0_u);
+    ctx.run();
+    expect(received == 100_u);
+  };
+
+  "complete inline from the executor"_test = [] {
+    asio::io_context ctx{};
+    slot_t slot{};
+    std::size_t received{};
+    slot.emplace([&](std::error_code, std::string message) { received = message.size(); }, ctx.get_executor());
+    asio::post(ctx, [&] {
+      slot.complete({}, "reply");
+      expect(received == 5_u);
+    });
+    ctx.run();
+  };
+
+  "post is never inline"_test = [] {
+    asio::io_context ctx{};
+    slot_t slot{};
+    std::size_t received{};
+    slot.emplace([&](std::error_code, std::string message) { received = message.size(); }, ctx.get_executor());
+    asio::post(ctx, [&] {
+      slot.post({}, "reply");
+      expect(received == 0_u);
+    });
+    ctx.run();
+    expect(received == 5_u);
+  };
+
+  "associated allocator"_test = [] {
+    asio::io_context ctx{};
+    slot_t slot{};
+    std::size_t received{};
+    allocations = 0;
+    slot.emplace(counting_handler{ &received }, ctx.get_executor());
+    expect(allocations == 1_u);
+    slot.complete({}, "reply");
+    ctx.run();
+    expect(received == 5_u);
+  };
+
+  "reset drops the handler"_test = [] {
+    asio::io_context ctx{};
+    slot_t slot{};
+    bool invoked{};
+    slot.emplace([&](std::error_code, std::string) { invoked = true; }, ctx.get_executor());
+    slot.reset();
+    expect(!slot.has_handler());
+    ctx.run();
+    expect(!invoked);
+  };
+
+  "embedded in a serial map"_test = [] {
+    asio::io_context ctx{};
+    adbus::serial_map<slot_t> pending{};
+    std::size_t completed{};
+    for (std::uint32_t serial{ 1 }; serial <= 100; ++serial) {
+      pending.insert(serial, {})->emplace([&](std::error_code, std::string) { ++completed; }, ctx.get_executor());
+    }
+    // replies in reverse order, every erase moves the slots which follow
+    for (std::uint32_t serial{ 100 }; serial >= 1; --serial) {
+      auto slot{ pending.extract(serial) };
+      expect(fatal(slot.has_value() && slot->has_handler()));
+      slot->complete({}, {});
+    }
+    ctx.run();
+    expect(completed == 100_u);
+  };
+}
@@ -0,0 +1,176 @@
+#include <cstdint>
+#include <map>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+#include <boost/ut.hpp>
+#include <glaze/glaze.hpp>
+
+#include <adbus/protocol/dbus_value.hpp>
+#include <adbus/protocol/header_view.hpp>
+#include <adbus/protocol/message_header.hpp>
+#include <adbus/protocol/write.hpp>
+
+using namespace boost::ut;
+using std::string_view_literals::operator""sv;
+namespace protocol = adbus::protocol;
+namespace header = adbus::protocol::header;
+
+struct point {
+  std::int32_t x{};
+  std::int32_t y{};
+};
+
+// written at the beginning of the buffer, the members are laid out like the values of a body "ybd(ii)"
+struct typed_body {
+  std::uint8_t byte{};
+  bool flag{};
+  double ratio{};
+  point position{};
+};
+
+// laid out like the values of a body "ayad"
+struct arrays_body {
+  std::vector<std::uint8_t> bytes{};
+  std::vector<double> ratios{};
+};
+
+int main() {
+  "values of a message body"_test = [] {
+    using variant_t = std::variant<std::string, std::uint32_t, std::vector<std::int16_t>>;
+    std::map<std::string, variant_t> const properties{
+      { "Name", std::string{ "adbus" } }, { "Count", std::uint32_t{ 42 } }, { "Levels", std::vector<std::int16_t>{ -1, 2 } }
+    };
+    header::header const hdr{ .type = header::message_type_e::method_return,
+                              .serial = 2,
+                              .fields = {
+                                  { header::field_reply_serial{ 1 } },
+                                  { header::field_signature{ std::string_view{ "a{sv}" } } },
+                              } };
+    auto const message{ protocol::write_dbus_message(hdr, properties).value() };
+    auto const view{ header::header_view::make(message).value() };
+
+    std::pmr::monotonic_buffer_resource arena{};
+    auto const root{ protocol::parse_dbus_value(view, &arena) };
+    expect(fatal(root.has_value()));
+    expect((*root)->code() == 'r');
+    expect(fatal((*root)->size() == 1_u));
+    auto const& dict{ *(*root)->children().begin() };
+    expect(dict.code() == 'a');
+    expect(dict.signature() == "a{sv}"sv);
+    expect(fatal(dict.size() == 3_u));
+
+    std::map<std::string_view, std::string> seen{};
+    for (auto const& entry : dict.children()) {
+      expect(entry.code() == 'e');
+      auto it{ entry.children().begin() };
+      auto const key{ it->get<std::string_view>() };
+      auto const& variant{ *++it };
+      expect(variant.code() == 'v');
+      auto const& contained{ *variant.children().begin() };
+      std::string text{};
+      contained.visit([&](auto const& value) {
+        using V = std::decay_t<decltype(value)>;
+        if constexpr (std::same_as<V, protocol::dbus_value>) {
+          for (std::size_t idx{}; idx < value.size(); ++idx) {
+            text += std::to_string(*value.template element<std::int16_t>(idx)) + ",";
+          }
+        } else if constexpr (std::same_as<V, std::string_view>) {
+          text = value;
+        } else {
+          text = std::to_string(value);
+        }
+      });
+      seen.emplace(key.value(), text);
+    }
+    expect(seen == std::map<std::string_view, std::string>{ { "Name", "adbus" }, { "Count", "42" }, { "Levels", "-1,2," } });
+  };
+
+  "typed access"_test = [] {
+    auto const body{ protocol::write_dbus_binary(
+        typed_body{ .byte = 7, .flag = true, .ratio = 0.5, .position = { .x = 1, .y = -2 } }) };
+    expect(fatal(body.has_value()));
+    std::pmr::monotonic_buffer_resource arena{};
+    auto const root{ protocol::parse_dbus_value("ybd(ii)", *body, &arena) };
+    expect(fatal(root.has_value()));
+    auto it{ (*root)->children().begin() };
+    expect(it->get<std::uint8_t>() == std::uint8_t{ 7 });
+    // another type
+    expect(!it->get<std::uint32_t>().has_value());
+    expect((++it)->get<bool>() == true);
+    expect((++it)->get<double>() == 0.5);
+    auto const& structure{ *++it };
+    expect(structure.code() == 'r');
+    expect(structure.signature() == "(ii)"sv);
+    auto member{ structure.children().begin() };
+    expect(member->get<std::int32_t>() == 1);
+    expect((++member)->get<std::int32_t>() == -2);
+  };
+
+  "arrays of a fixed type are a single node"_test = [] {
+    std::vector<double> const ratios{ 0.5, -1.25, 3.0 };
+    auto const body{ protocol::write_dbus_binary(arrays_body{ .bytes = { 1, 2, 3, 4, 5 }, .ratios = ratios }) };
+    expect(fatal(body.has_value()));
+    std::pmr::monotonic_buffer_resource arena{};
+    auto const root{ protocol::parse_dbus_value("ayad", *body, &arena) };
+    expect(fatal(root.has_value()));
+    auto it{ (*root)->children().begin() };
+    auto const& bytes{ *it };
+    expect(bytes.is_fixed_array());
+    expect(bytes.size() == 5_u);
+    expect(bytes.children().begin() == bytes.children().end());
+    expect(bytes.fixed_elements() == "\x01\x02\x03\x04\x05"sv);
+    expect(bytes.element<std::uint8_t>(4) == std::uint8_t{ 5 });
+    expect(!bytes.element<std::uint8_t>(5).has_value());
+    // another type
+    expect(!bytes.element<std::uint32_t>(0).has_value());
+    auto const& doubles{ *++it };
+    expect(fatal(doubles.size() == 3_u));
+    expect(doubles.fixed_elements().size() == 3 * sizeof(double));
+    for (std::size_t idx{}; idx < ratios.size(); ++idx) {
+      expect(doubles.element<double>(idx) == ratios[idx]);
+    }
+    expect(!(*root)->is_fixed_array());
+
+    // clang-format off
+    std::vector<std::uint8_t> const big_endian{
+      0, 0, 0, 8,  // byte length
+      0, 0, 1, 2,
+      0xff, 0xff, 0xff, 0xfe,
+    };
+    // clang-format on
+    std::string_view const big_endian_bytes{ reinterpret_cast<char const*>(big_endian.data()), big_endian.size() };
+    auto const swapped{ protocol::parse_dbus_value("ai", big_endian_bytes, &arena, std::endian::big) };
+    expect(fatal(swapped.has_value()));
+    auto const& ints{ *(*swapped)->children().begin() };
+    expect(ints.element<std::int32_t>(0) == 0x0102);
+    expect(ints.element<std::int32_t>(1) == -2);
+    // the byte length is not a multiple of the element size
+    auto odd{ big_endian };
+    odd[3] = 7;
+    expect(protocol::parse_dbus_value("an", { reinterpret_cast<char const*>(odd.data()), odd.size() }, &arena,
+                                      std::endian::big)
+               .error()
+               .code == protocol::error_code::out_of_range);
+  };
+
+  "invalid input"_test = [] {
+    std::pmr::monotonic_buffer_resource arena{};
+    auto const body{ protocol::write_dbus_binary(std::string{ "text" }).value() };
+    expect(protocol::parse_dbus_value("s", std::string_view{ body }.substr(0, body.size() - 1), &arena).error().code ==
+           protocol::error_code::out_of_range);
+    expect(protocol::parse_dbus_value("a{vs}", body, &arena).error().code == protocol::error_code::invalid_signature);
+    expect(protocol::parse_dbus_value("(", body, &arena).error().code == protocol::error_code::invalid_signature);
+
+    // a variant holding a variant holding a variant ...
+    std::string nested{};
+    for (std::size_t idx{}; idx < 100; ++idx) {
+      nested += "\x01v"sv;
+      nested += '\0';
+    }
+    expect(protocol::parse_dbus_value("v", nested, &arena).error().code == protocol::error_code::nesting_too_deep);
+  };
+}
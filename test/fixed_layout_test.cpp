@@ -0,0 +1,163 @@
+#include <bit>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <boost/ut.hpp>
+#include <glaze/glaze.hpp>
+
+#include <adbus/protocol/fixed_layout.hpp>
+#include <adbus/protocol/message_header.hpp>
+#include <adbus/protocol/read.hpp>
+#include <adbus/protocol/size.hpp>
+#include <adbus/protocol/write.hpp>
+#include <adbus/util/byteswap.hpp>
+
+#include "common.hpp"
+
+using namespace boost::ut;
+
+// Shaped like a high rate status message
+struct status {
+  std::uint8_t mode{};
+  bool running{};
+  std::int16_t temperature{};
+  std::uint64_t uptime{};
+  enum_as_number state{};
+  double load{};
+  std::uint32_t errors{};
+  constexpr auto operator==(status const&) const noexcept -> bool = default;
+};
+
+struct nested_status {
+  std::uint16_t id{};
+  status inner{};
+  std::uint8_t flags{};
+  constexpr auto operator==(nested_status const&) const noexcept -> bool = default;
+};
+
+struct not_fixed {
+  std::uint32_t id{};
+  std::string name{};
+};
+
+struct const_member {
+  const std::uint32_t id{};
+  std::uint32_t value{};
+};
+
+namespace protocol = adbus::protocol;
+
+static_assert(protocol::fixed_struct<status>);
+static_assert(protocol::fixed_struct<nested_status>);
+static_assert(!protocol::fixed_struct<not_fixed>);
+static_assert(!protocol::fixed_struct<std::uint32_t>);
+static_assert(!protocol::fixed_struct<std::vector<std::uint8_t>>);
+// decoded in place, a const member can not be written
+static_assert(!protocol::fixed_struct<const_member>);
+static_assert(protocol::fixed_struct<protocol::header::fixed_header>);
+
+// y, b as UINT32, n, t, y, d, u
+static_assert(protocol::detail::fixed_layout<status>::offsets == std::array<std::size_t, 7>{ 0, 4, 8, 16, 24, 32, 40 });
+static_assert(protocol::dbus_fixed_size_v<status> == 44);
+// q, the inner struct on the next 8-byte boundary, y
+static_assert(protocol::detail::fixed_layout<nested_status>::offsets == std::array<std::size_t, 3>{ 0, 8, 52 });
+static_assert(protocol::dbus_fixed_size_v<nested_status> == 53);
+static_assert(protocol::dbus_fixed_size_v<std::uint16_t> == 2);
+
+int main() {
+  constexpr status value{ .mode = 3,
+                          .running = true,
+                          .temperature = -40,
+                          .uptime = 0x0102030405060708,
+                          .state = enum_as_number::b,
+                          .load = 0.75,
+                          .errors = 7 };
+
+  "same bytes as writing member by member"_test = [&] {
+    for (std::size_t offset : { 0U, 1U, 5U, 8U }) {
+      std::string block(offset, '\x7f');
+      expect(!protocol::write_dbus_binary(value, block));
+
+      // the generic path, a struct is aligned to 8 and then every member is padded to its own alignment
+      std::string expected(offset, '\x7f');
+      std::size_t idx{ expected.size() };
+      expected.resize((idx + 7) / 8 * 8, '\0');
+      expect(!protocol::write_dbus_binary(value.mode, expected));
+      expect(!protocol::write_dbus_binary(value.running, expected));
+      expect(!protocol::write_dbus_binary(value.temperature, expected));
+      expect(!protocol::write_dbus_binary(value.uptime, expected));
+      expect(!protocol::write_dbus_binary(value.state, expected));
+      expect(!protocol::write_dbus_binary(value.load, expected));
+      expect(!protocol::write_dbus_binary(value.errors, expected));
+
+      expect(block == expected) << "offset" << offset;
+      expect(block.size() - offset == protocol::dbus_size(value, offset));
+    }
+  };
+
+  "round trip"_test = [&] {
+    auto const bytes{ protocol::write_dbus_binary(value) };
+    expect(fatal(bytes.has_value()));
+    expect(protocol::read_dbus_binary<status>(*bytes) == value);
+
+    nested_status const nested{ .id = 9, .inner = value, .flags = 0xff };
+    auto const nested_bytes{ protocol::write_dbus_binary(nested) };
+    expect(fatal(nested_bytes.has_value()));
+    expect(nested_bytes->size() == protocol::dbus_fixed_size_v<nested_status>);
+    expect(protocol::read_dbus_binary<nested_status>(*nested_bytes) == nested);
+
+    std::vector<status> const statuses(3, value);
+    auto const array_bytes{ protocol::write_dbus_binary(statuses) };
+    expect(fatal(array_bytes.has_value()));
+    expect(protocol::read_dbus_binary<std::vector<status>>(*array_bytes) == statuses);
+  };
+
+  "other byte order"_test = [&] {
+    using adbus::util::byteswap;
+    // every member swapped and written in the host order are the bytes of value in the other order
+    status const swapped{ .mode = value.mode,
+                          .running = value.running,
+                          .temperature = byteswap(value.temperature),
+                          .uptime = byteswap(value.uptime),
+                          .state = value.state,
+                          .load = byteswap(value.load),
+                          .errors = byteswap(value.errors) };
+    auto const bytes{ protocol::write_dbus_binary(swapped).value() };
+    constexpr auto other{ std::endian::native == std::endian::little ? std::endian::big : std::endian::little };
+    status decoded{};
+    expect(!protocol::read_dbus_binary(decoded, bytes, other));
+    expect(decoded == value);
+  };
+
+  "truncated input"_test = [&] {
+    auto bytes{ protocol::write_dbus_binary(value).value() };
+    bytes.pop_back();
+    expect(!protocol::read_dbus_binary<status>(bytes).has_value());
+  };
+
+  "fixed part of a message header"_test = [] {
+    namespace header = protocol::header;
+    header::header const hdr{ .type = header::message_type_e::method_return,
+                              .flags = header::flags_t{ .no_auto_start = true },
+                              .serial = 7,
+                              .fields = { { header::field_reply_serial{ 3 } } } };
+    auto const bytes{ protocol::write_dbus_binary(hdr).value() };
+    header::fixed_header fixed{};
+    expect(!protocol::read_dbus_binary(fixed, bytes));
+    expect(fixed.endian == hdr.endian);
+    expect(fixed.type == header::message_type_e::method_return);
+    expect(fixed.flags.no_auto_start);
+    expect(!fixed.flags.no_reply_expected);
+    expect(fixed.version == std::byte{ 1 });
+    expect(fixed.serial == 7_u);
+    // code, signature and the padded uint32
+    expect(fixed.fields_array_len == 8_u);
+    expect(sizeof(header::fixed_header) + fixed.fields_array_len == bytes.size());
+  };
+
+  "fixed capacity buffer"_test = [&] {
+    std::array<char, 16> small{};
+    expect(protocol::write_dbus_binary(value, small).code == adbus::error_code::buffer_too_small);
+  };
+}
@@ -0,0 +1,216 @@
+#include <bit>
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include <boost/ut.hpp>
+
+#include <adbus/protocol/header_view.hpp>
+#include <adbus/protocol/methods.hpp>
+#include <adbus/protocol/read.hpp>
+#include <adbus/protocol/write.hpp>
+
+using namespace boost::ut;
+using std::string_view_literals::operator""sv;
+using std::string_literals::operator""s;
+namespace header = adbus::protocol::header;
+
+struct request_name_body {
+  std::string name{};
+  std::uint32_t flags{};
+};
+
+int main() {
+  using header::header_view;
+
+  "view of every field"_test = [] {
+    using header::field_destination, header::field_interface, header::field_member, header::field_path,
+        header::field_reply_serial, header::field_sender, header::field_signature, header::field_unix_fds,
+        header::flags_t, header::message_type_e;
+    request_name_body const body{ .name = "com.example.Name", .flags = 4 };
+    header::header const hdr{ .type = message_type_e::method_call,
+                              .flags = { .no_auto_start = true },
+                              .serial = 1337,
+                              .fields = {
+                                  { field_path{ adbus::protocol::path::make("/org/freedesktop/DBus").value() } },
+                                  { field_interface{ "org.freedesktop.DBus" } },
+                                  { field_member{ "RequestName" } },
+                                  { field_reply_serial{ 42 } },
+                                  { field_destination{ "org.freedesktop.DBus" } },
+                                  { field_sender{ ":1.82" } },
+                                  { field_signature{ "su"sv } },
+                                  { field_unix_fds{ 3 } },
+                              } };
+    auto const message{ adbus::protocol::write_dbus_message(hdr, body).value() };
+
+    auto view{ header_view::make(message) };
+    expect(fatal(view.has_value())) << fmt::format("error: {}", view.error_or(adbus::protocol::error{}));
+    expect(view->type() == message_type_e::method_call);
+    expect(view->flags() == flags_t{ .no_auto_start = true });
+    expect(view->serial() == 1337_u);
+    expect(view->path() == "/org/freedesktop/DBus"sv);
+    expect(view->interface() == "org.freedesktop.DBus"sv);
+    expect(view->member() == "RequestName"sv);
+    expect(!view->error_name().has_value());
+    expect(view->reply_serial() == 42u);
+    expect(view->destination() == "org.freedesktop.DBus"sv);
+    expect(view->sender() == ":1.82"sv);
+    expect(view->signature() == "su"sv);
+    expect(view->unix_fds() == 3u);
+    expect(view->header_size() % 8 == 0_u);
+    expect(view->message_size() == message.size());
+
+    expect(view->body() == adbus::protocol::write_dbus_binary(body).value());
+
+    // the offsets stay valid in a copy of the bytes
+    std::string const copy{ message };
+    auto const rebound{ view->rebind(copy) };
+    expect(rebound.member()->data() == copy.data() + (view->member()->data() - message.data()));
+    expect(rebound.member() == "RequestName"sv);
+  };
+
+  "missing fields"_test = [] {
+    auto const message{ adbus::protocol::write_dbus_binary(header::header{ .serial = 1 }).value() };
+    auto view{ header_view::make(message) };
+    expect(fatal(view.has_value()));
+    expect(view->serial() == 1_u);
+    expect(!view->path().has_value());
+    expect(!view->reply_serial().has_value());
+    expect(!view->signature().has_value());
+    expect(view->body().empty());
+  };
+
+  "unknown field codes are skipped"_test = [] {
+    // clang-format off
+    std::vector<std::uint8_t> const buffer{
+      'l', 2, 0, 1,  // endian, method return, flags, version
+      0, 0, 0, 0,    // body length
+      2, 0, 0, 0,    // serial
+      16, 0, 0, 0,   // field array byte length
+      42, 1, 'u', 0, 7, 0, 0, 0,  // unknown code 42 holding a uint32
+      5, 1, 'u', 0, 1, 0, 0, 0,   // REPLY_SERIAL
+    };
+    // clang-format on
+    auto view{ header_view::make({ reinterpret_cast<const char*>(buffer.data()), buffer.size() }) };
+    expect(fatal(view.has_value())) << fmt::format("error: {}", view.error_or(adbus::protocol::error{}));
+    expect(view->reply_serial() == 1u);
+  };
+
+  "unknown field codes holding containers are skipped"_test = [] {
+    // clang-format off
+    std::vector<std::uint8_t> const buffer{
+      'l', 2, 0, 1,  // endian, method return, flags, version
+      0, 0, 0, 0,    // body length
+      2, 0, 0, 0,    // serial
+      40, 0, 0, 0,   // field array byte length
+      42, 5, 'a', '{', 's', 'v', '}', 0,  // unknown code 42 holding a dictionary
+      16, 0, 0, 0, 0, 0, 0, 0,            // byte length of the dictionary, padding to its first entry
+      1, 0, 0, 0, 'k', 0, 1, 'u',         // key "k", variant of a uint32
+      0, 0, 0, 0, 7, 0, 0, 0,             // padding, 7
+      5, 1, 'u', 0, 1, 0, 0, 0,           // REPLY_SERIAL
+    };
+    // clang-format on
+    auto view{ header_view::make({ reinterpret_cast<const char*>(buffer.data()), buffer.size() }) };
+    expect(fatal(view.has_value())) << fmt::format("error: {}", view.error_or(adbus::protocol::error{}));
+    expect(view->reply_serial() == 1u);
+
+    // the dictionary claims more bytes than the fields array holds
+    auto truncated{ buffer };
+    truncated[24] = 17;
+    expect(!header_view::make({ reinterpret_cast<const char*>(truncated.data()), truncated.size() }).has_value());
+  };
+
+  "big endian message"_test = [] {
+    // clang-format off
+    std::vector<std::uint8_t> const buffer{
+      'B', 2, 0, 1,  // endian, method return, flags, version
+      0, 0, 0, 4,    // body length
+      0, 0, 1, 2,    // serial
+      0, 0, 0, 15,   // field array byte length
+      5, 1, 'u', 0, 0, 0, 0, 7,           // REPLY_SERIAL
+      8, 1, 'g', 0, 1, 'u', 0,            // SIGNATURE
+      0,                                  // padding
+      0x01, 0x02, 0x03, 0x04,             // body
+    };
+    // clang-format on
+    auto view{ header_view::make({ reinterpret_cast<const char*>(buffer.data()), buffer.size() }) };
+    expect(fatal(view.has_value())) << fmt::format("error: {}", view.error_or(adbus::protocol::error{}));
+    expect(view->byte_order() == std::endian::big);
+    expect(view->serial() == 0x0102u);
+    expect(view->reply_serial() == 7u);
+    expect(view->signature() == "u"sv);
+    expect(view->body().size() == 4_u);
+    auto const body{ adbus::protocol::read_dbus_binary<std::uint32_t>(view->body(), view->byte_order(),
+                                                                           std::pmr::get_default_resource()) };
+    expect(body == 0x01020304u);
+  };
+
+  "malformed headers"_test = [] {
+    using adbus::protocol::error_code;
+    auto const message{ adbus::protocol::write_dbus_binary(adbus::protocol::methods::hello()).value() };
+    for (std::size_t size{}; size < message.size(); ++size) {
+      auto view{ header_view::make(std::string_view{ message }.substr(0, size)) };
+      expect(!view.has_value() && view.error().code == error_code::out_of_range)
+          << fmt::format("Expected out_of_range for size: {}", size);
+    }
+
+    // clang-format off
+    std::vector<std::uint8_t> const wrong_signature{
+      'l', 2, 0, 1,
+      0, 0, 0, 0,
+      2, 0, 0, 0,
+      8, 0, 0, 0,
+      5, 1, 's', 0, 1, 0, 0, 0,  // REPLY_SERIAL must be a uint32
+    };
+    // clang-format on
+    auto view{ header_view::make({ reinterpret_cast<const char*>(wrong_signature.data()), wrong_signature.size() }) };
+    expect(!view.has_value() && view.error().code == error_code::unexpected_variant);
+
+    // clang-format off
+    std::vector<std::uint8_t> const signature_at_end{
+      'l', 2, 0, 1,
+      0, 0, 0, 0,
+      2, 0, 0, 0,
+      4, 0, 0, 0,
+      8, 1, 'g', 0,  // SIGNATURE whose value is cut off at the end of the message
+    };
+    // clang-format on
+    auto cut{ header_view::make({ reinterpret_cast<const char*>(signature_at_end.data()), signature_at_end.size() }) };
+    expect(!cut.has_value() && cut.error().code == error_code::out_of_range);
+  };
+
+  "body of a cut off message"_test = [] {
+    request_name_body const body{ .name = "com.example.Name", .flags = 4 };
+    auto const message{ adbus::protocol::write_dbus_message(adbus::protocol::methods::request_name(), body).value() };
+    auto const full{ header_view::make(message) };
+    expect(fatal(full.has_value()));
+    // the header is followed by its padding and then the body
+    auto const end_of_fields{ header_view::fixed_size + full->fields_array_len() };
+    for (auto const size : { end_of_fields, full->header_size(), full->header_size() + 3, message.size() }) {
+      auto view{ header_view::make(std::string_view{ message }.substr(0, size)) };
+      expect(fatal(view.has_value()));
+      auto const expected{ size <= full->header_size()
+                               ? ""sv
+                               : std::string_view{ message }.substr(full->header_size(), size - full->header_size()) };
+      expect(view->body() == expected) << fmt::format("Unexpected body for size: {}", size);
+    }
+  };
+
+  "peek message size"_test = [] {
+    request_name_body const body{ .name = "com.example.Name", .flags = 4 };
+    auto const message{ adbus::protocol::write_dbus_message(adbus::protocol::methods::request_name(), body).value() };
+    // two messages back to back as received from a stream
+    std::string const stream{ message + message };
+    for (std::size_t size{}; size < header_view::fixed_size; ++size) {
+      expect(!header_view::peek_message_size(std::string_view{ stream }.substr(0, size)).has_value());
+    }
+    expect(header_view::peek_message_size(std::string_view{ stream }.substr(0, header_view::fixed_size)) ==
+           message.size());
+    expect(header_view::peek_message_size(stream) == message.size());
+    expect(header_view::peek_message_size(std::string_view{ stream }.substr(message.size())) == message.size());
+  };
+}
@@ -0,0 +1,213 @@
+#include <cstdint>
+#include <expected>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include <boost/ut.hpp>
+
+#include <adbus/core/buffer_pool.hpp>
+#include <adbus/core/object_server.hpp>
+#include <adbus/core/serial_counter.hpp>
+#include <adbus/protocol/header_view.hpp>
+#include <adbus/protocol/read.hpp>
+#include <adbus/protocol/write.hpp>
+
+using namespace boost::ut;
+using std::string_view_literals::operator""sv;
+namespace header = adbus::protocol::header;
+
+struct add_params {
+  std::int32_t lhs{};
+  std::int32_t rhs{};
+};
+
+// A method call as received, with the bytes its view refers to
+struct call_message {
+  std::string bytes{};
+  header::header_view view{};
+};
+
+template <typename body_t = glz::skip>
+auto make_call(std::string_view member,
+               body_t const& body = {},
+               std::string_view interface = "org.example.Calculator",
+               header::flags_t flags = {}) -> call_message {
+  namespace protocol = adbus::protocol;
+  header::header hdr{ .type = header::message_type_e::method_call,
+                      .flags = flags,
+                      .serial = 42,
+                      .fields = {
+                          { header::field_path{ protocol::path::make("/org/example/Calculator").value() } },
+                          { header::field_member{ protocol::member_name::make(member).value() } },
+                          { header::field_sender{ std::pmr::string{ ":1.7" } } },
+                      } };
+  if (!interface.empty()) {
+    hdr.fields.emplace_back(header::field_interface{ protocol::interface_name::make(interface).value() });
+  }
+  if constexpr (!std::same_as<body_t, glz::skip>) {
+    hdr.fields.emplace_back(header::field_signature{ protocol::type::signature_v<body_t> });
+  }
+  call_message output{ .bytes = protocol::write_dbus_message(hdr, body).value() };
+  output.view = header::header_view::make(output.bytes).value();
+  return output;
+}
+
+struct fixture {
+  adbus::serial_counter serials{};
+  std::vector<std::string> sent{};
+  adbus::object_server server{ serials, [this](adbus::buffer_pool::buffer&& reply) { sent.emplace_back(*reply); } };
+};
+
+int main() {
+  using adbus::method_error;
+  using adbus::object_server;
+
+  "reply to a call"_test = [] {
+    fixture fix{};
+    expect(fix.server.add_method<add_params, std::int32_t>("/org/example/Calculator", "org.example.Calculator", "Add",
+                                                           [](add_params const& params) { return params.lhs + params.rhs; }));
+    // the same method twice
+    expect(!fix.server.add_method<add_params, std::int32_t>("/org/example/Calculator", "org.example.Calculator", "Add",
+                                                            [](add_params const&) { return 0; }));
+    expect(fix.server.size() == 1_u);
+
+    auto const call{ make_call("Add", add_params{ .lhs = 40, .rhs = 2 }) };
+    expect(fix.server.dispatch(call.view));
+    expect(fatal(fix.sent.size() == 1_u));
+    auto const reply{ header::header_view::make(fix.sent.front()) };
+    expect(fatal(reply.has_value()));
+    expect(reply->type() == header::message_type_e::method_return);
+    expect(reply->reply_serial() == 42u);
+    expect(reply->destination() == ":1.7"sv);
+    expect(reply->signature() == "i"sv);
+    expect(reply->serial() != 0_u);
+    expect(adbus::protocol::read_dbus_binary<std::int32_t>(reply->body()) == 42);
+  };
+
+  "call without interface"_test = [] {
+    fixture fix{};
+    fix.server.add_method<void, std::string>("/org/example/Calculator", "org.example.Calculator", "Name",
+                                            [] { return std::string{ "calculator" }; });
+    expect(fix.server.dispatch(make_call("Name", glz::skip{}, "").view));
+    expect(fatal(fix.sent.size() == 1_u));
+    auto const reply{ header::header_view::make(fix.sent.front()).value() };
+    expect(adbus::protocol::read_dbus_binary<std::string>(reply.body()) == "calculator"sv);
+  };
+
+  "call without interface after removing one of two interfaces"_test = [] {
+    fixture fix{};
+    fix.server.add_method<void, std::string>("/org/example/Calculator", "org.example.First", "Name",
+                                            [] { return std::string{ "first" }; });
+    fix.server.add_method<void, std::string>("/org/example/Calculator", "org.example.Second", "Name",
+                                            [] { return std::string{ "second" }; });
+    auto name_of{ [&fix] {
+      fix.sent.clear();
+      fix.server.dispatch(make_call("Name", glz::skip{}, "").view);
+      expect(fatal(fix.sent.size() == 1_u));
+      auto const reply{ header::header_view::make(fix.sent.front()).value() };
+      return adbus::protocol::read_dbus_binary<std::string>(reply.body()).value_or("");
+    } };
+    expect(name_of() == "first"sv);
+    expect(fix.server.remove_method("/org/example/Calculator", "org.example.First", "Name"));
+    expect(name_of() == "second"sv);
+    expect(fix.server.remove_method("/org/example/Calculator", "org.example.Second", "Name"));
+    expect(!fix.server.dispatch(make_call("Name", glz::skip{}, "").view));
+  };
+
+  "handlers may change the registry"_test = [] {
+    fixture fix{};
+    fix.server.add_method<void, void>("/org/example/Calculator", "org.example.Calculator", "Once", [&fix] {
+      // the registry is not locked while a handler runs, the handler outlives its removal
+      expect(fix.server.remove_method("/org/example/Calculator", "org.example.Calculator", "Once"));
+      expect(fix.server.add_method<void, void>("/org/example/Calculator", "org.example.Calculator", "Next", [] {}));
+    });
+    expect(fix.server.dispatch(make_call("Once").view));
+    expect(fix.sent.size() == 1_u);
+    expect(fix.server.size() == 1_u);
+    expect(!fix.server.dispatch(make_call("Once").view));
+    expect(fix.server.dispatch(make_call("Next").view));
+  };
+
+  "error replies"_test = [] {
+    fixture fix{};
+    fix.server.add_method<add_params, std::int32_t>(
+        "/org/example/Calculator", "org.example.Calculator", "Divide",
+        [](add_params const& params) -> std::expected<std::int32_t, method_error> {
+          if (params.rhs == 0) {
+            return std::unexpected{ method_error{ .name = "org.example.Error.DivideByZero", .message = "rhs is 0" } };
+          }
+          return params.lhs / params.rhs;
+        });
+
+    auto error_of{ [&fix](call_message const& call) -> std::string {
+      fix.sent.clear();
+      fix.server.dispatch(call.view);
+      if (fix.sent.size() != 1) {
+        return {};
+      }
+      auto const reply{ header::header_view::make(fix.sent.front()).value() };
+      expect(reply.type() == header::message_type_e::error);
+      expect(reply.reply_serial() == 42u);
+      expect(reply.signature() == "s"sv);
+      return std::string{ reply.error_name().value_or("") };
+    } };
+    expect(error_of(make_call("Divide", add_params{ .lhs = 1, .rhs = 0 })) == "org.example.Error.DivideByZero"sv);
+    expect(error_of(make_call("Divide", std::string{ "wrong" })) == adbus::errors::invalid_args);
+    expect(error_of(make_call("Multiply", add_params{})) == adbus::errors::unknown_method);
+    expect(!fix.server.dispatch(make_call("Multiply", add_params{}).view));
+
+    expect(fix.server.remove_method("/org/example/Calculator", "org.example.Calculator", "Divide"));
+    expect(error_of(make_call("Divide", add_params{ .lhs = 4, .rhs = 2 })) == adbus::errors::unknown_method);
+  };
+
+  "deferred replies"_test = [] {
+    fixture fix{};
+    std::vector<object_server::responder> waiting{};
+    fix.server.add_method<std::string, void>(
+        "/org/example/Calculator", "org.example.Calculator", "Store",
+        [&waiting](std::string const&, object_server::responder to) { waiting.emplace_back(std::move(to)); });
+    fix.server.dispatch(make_call("Store", std::string{ "value" }).view);
+    expect(fix.sent.empty());
+    expect(fatal(waiting.size() == 1_u));
+    expect(waiting.front().expects_reply());
+    waiting.front().reply();
+    // a responder replies once
+    waiting.front().reply();
+    expect(!waiting.front().expects_reply());
+    expect(fatal(fix.sent.size() == 1_u));
+    auto const reply{ header::header_view::make(fix.sent.front()).value() };
+    expect(reply.type() == header::message_type_e::method_return);
+    expect(!reply.signature().has_value());
+    expect(reply.body().empty());
+  };
+
+  "no reply expected"_test = [] {
+    fixture fix{};
+    std::size_t calls{};
+    fix.server.add_method<std::string, void>("/org/example/Calculator", "org.example.Calculator", "Log",
+                                            [&calls](std::string const&) { ++calls; });
+    fix.server.dispatch(make_call("Log", std::string{ "line" }, "org.example.Calculator",
+                                  header::flags_t{ .no_reply_expected = true })
+                            .view);
+    expect(calls == 1_u);
+    expect(fix.sent.empty());
+  };
+
+  "pooled buffers keep their capacity"_test = [] {
+    adbus::buffer_pool pool{ 2 };
+    std::size_t capacity{};
+    {
+      auto buffer{ pool.acquire() };
+      buffer->assign(1000, 'x');
+      capacity = buffer->capacity();
+    }
+    expect(pool.size() == 1_u);
+    auto buffer{ pool.acquire() };
+    expect(buffer->empty());
+    expect(buffer->capacity() == capacity);
+    expect(pool.size() == 0_u);
+  };
+}
@@ -1,17 +1,24 @@
+#include <algorithm>
 #include <array>
+#include <bit>
+#include <cstring>
+#include <span>
 #include <tuple>
 
 #include <fmt/format.h>
 
 #include <boost/ut.hpp>
 #include <forward_list>
+#include <memory_resource>
 #include <glaze/glaze.hpp>
 #include <set>
 #include <unordered_set>
 
 #include <adbus/protocol/message_header.hpp>
+#include <adbus/protocol/methods.hpp>
 #include <adbus/protocol/read.hpp>
 #include <adbus/protocol/signature.hpp>
+#include <adbus/protocol/write.hpp>
 
 #include "common.hpp"
 
@@ -21,6 +28,20 @@ using std::string_literals::operator""s;
 namespace header = adbus::protocol::header;
 
 
+struct counting_resource : std::pmr::memory_resource {
+  std::size_t allocations{};
+
+private:
+  auto do_allocate(std::size_t bytes, std::size_t alignment) -> void* override {
+    ++allocations;
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+  }
+  void do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) override {
+    std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+  }
+  auto do_is_equal(std::pmr::memory_resource const& other) const noexcept -> bool override { return this == &other; }
+};
+
 namespace std {
 template <typename... Args>
 constexpr auto format_as(variant<Args...> const& var) noexcept -> std::string {
@@ -142,6 +163,58 @@ int main() {
     },
   };
 
+  "large array of fixed types"_test = [] {
+    std::vector<double> expected(4099, 1337.42);
+    std::vector<std::uint8_t> buffer{
+      0, 0, 0, 0,  // size
+      0, 0, 0, 0,  // padding
+    };
+    const auto n{ static_cast<std::uint32_t>(expected.size() * sizeof(double)) };
+    std::memcpy(buffer.data(), &n, sizeof(n));
+    buffer.resize(buffer.size() + n);
+    std::memcpy(buffer.data() + 8, expected.data(), n);
+    std::vector<double> value{ 1.0, 2.0 };
+    auto err = read_dbus_binary(value, buffer);
+    expect(!err) << fmt::format("error: {}", err);
+    expect(value == expected);
+
+    std::array<double, 3> too_small{};
+    err = read_dbus_binary(too_small, buffer);
+    expect(err.code == adbus::protocol::error_code::out_of_range);
+
+    buffer[0] = 7;  // not a multiple of the element size
+    err = read_dbus_binary(value, buffer);
+    expect(err.code == adbus::protocol::error_code::out_of_range);
+  };
+
+  "zero copy view of fixed types"_test = [] {
+    std::vector<std::uint8_t> buffer{
+      16, 0, 0, 0,              // size
+      0,  0, 0, 0,              // padding
+      1,  0, 0, 0, 0, 0, 0, 0,  // 1
+      2,  0, 0, 0, 0, 0, 0, 0,  // 2
+    };
+    std::span<const std::uint64_t> view{};
+    auto err = read_dbus_binary(view, buffer);
+    expect(!err) << fmt::format("error: {}", err);
+    expect(view.size() == 2);
+    expect(reinterpret_cast<const std::uint8_t*>(view.data()) == buffer.data() + 8);
+    expect(view[0] == 1 && view[1] == 2);
+
+    std::vector<std::uint8_t> bytes{ 3, 0, 0, 0, 'a', 'y', '!' };
+    std::span<const std::uint8_t> byte_view{};
+    err = read_dbus_binary(byte_view, bytes);
+    expect(!err) << fmt::format("error: {}", err);
+    expect(byte_view.size() == 3);
+    expect(byte_view.data() == bytes.data() + 4);
+
+    // the padding is relative to the beginning of the message, which here is not 8 byte aligned in memory
+    std::vector<std::uint8_t> shifted(buffer.size() + 1);
+    std::copy(buffer.begin(), buffer.end(), shifted.begin() + 1);
+    err = read_dbus_binary(view, std::span<const std::uint8_t>{ shifted.data() + 1, buffer.size() });
+    expect(err.code == adbus::protocol::error_code::unaligned);
+  };
+
   "vector of strings"_test = generic_test_case | std::tuple{
     generic_test{
       .expected = std::vector{ "bar"s, "baz"s, "foo"s },
@@ -392,6 +465,27 @@ int main() {
       },
     },
   };
+  "variant alternatives sharing a first character"_test = [] {
+    using variant_t = std::variant<std::vector<std::string>, std::uint32_t, std::vector<std::uint32_t>, std::uint8_t>;
+    std::vector<std::uint8_t> buffer{
+      2, 'a', 'u', 0,  // length of signature + signature for array of uint32
+      4, 0,   0,   0,  // array length
+      7, 0,   0,   0,  // uint32 value
+    };
+    variant_t value{};
+    auto err = read_dbus_binary(value, buffer);
+    expect(!err) << fmt::format("error: {}", err);
+    expect(value == variant_t{ std::vector<std::uint32_t>{ 7 } });
+
+    // a prefix of an alternative is not a match
+    std::vector<std::uint8_t> unknown{ 1, 'a', 0 };
+    err = read_dbus_binary(value, unknown);
+    expect(err.code == adbus::protocol::error_code::unexpected_variant);
+
+    unknown = { 1, 'x', 0 };
+    err = read_dbus_binary(value, unknown);
+    expect(err.code == adbus::protocol::error_code::unexpected_variant);
+  };
   "header with path"_test = generic_test_case | std::tuple{
     generic_test{ .expected = header::header{ .type = header::message_type_e::method_call,
                                               .flags = {},
@@ -445,6 +539,143 @@ int main() {
         }
     }
   };
+  "header with unknown fields"_test = generic_test_case | std::tuple{
+    generic_test{ .expected = header::header{ .type = header::message_type_e::method_return,
+                                              .flags = {},
+                                              .body_length = 0,
+                                              .serial = 1,
+                                              .fields = { { header::field_reply_serial{ 7 } } } },
+        .buffer = {
+            'l',               // endian
+            2,                 // message type method return
+            0,                 // flags none
+            1,                 // version 1
+            0,   0,   0,   0,  // body length
+            1,   0,   0,   0,  // serial
+            32,  0,   0,   0,  // field array byte length
+            42,                // unknown field code
+            1,   'u', 0,       // signature
+            9,   0,   0,   0,  // ignored value
+            43,                // unknown field code
+            1,   's', 0,       // signature
+            3,   0,   0,   0,  // size of string
+            'a', 'b', 'c', 0,  // ignored value
+            0,   0,   0,   0,  // padding
+            5,                 // field code of REPLY_SERIAL
+            1,   'u', 0,       // signature
+            7,   0,   0,   0,  // reply serial
+        }
+    }
+  };
+  "big endian header"_test = generic_test_case | std::tuple{
+    generic_test{ .expected = header::header{ .endian = std::byte{ 'B' },
+                                              .type = header::message_type_e::method_return,
+                                              .flags = {},
+                                              .body_length = 0,
+                                              .serial = 0x0102,
+                                              .fields = { { header::field_reply_serial{ 7 } } } },
+        .buffer = {
+            'B',               // endian
+            2,                 // message type method return
+            0,                 // flags none
+            1,                 // version 1
+            0,   0,   0,   0,  // body length
+            0,   0,   1,   2,  // serial
+            0,   0,   0,   8,  // field array byte length
+            5,                 // field code of REPLY_SERIAL
+            1,   'u', 0,       // signature
+            0,   0,   0,   7,  // reply serial
+        }
+    }
+  };
+  "arrays in the other byte order"_test = [] {
+    constexpr auto other{ std::endian::native == std::endian::little ? std::endian::big : std::endian::little };
+    // long enough for the vectorized swap and a remainder
+    std::vector<std::uint32_t> expected(37);
+    std::vector<std::uint64_t> expected_wide(11);
+    for (std::uint32_t idx{}; idx < expected.size(); ++idx) {
+      expected[idx] = 0x01020304 * (idx + 1);
+    }
+    for (std::uint64_t idx{}; idx < expected_wide.size(); ++idx) {
+      expected_wide[idx] = 0x0102030405060708 * (idx + 1);
+    }
+    auto swapped{ expected };
+    std::ranges::transform(swapped, swapped.begin(), [](auto value) { return std::byteswap(value); });
+    auto swapped_wide{ expected_wide };
+    std::ranges::transform(swapped_wide, swapped_wide.begin(), [](auto value) { return std::byteswap(value); });
+
+    // the length is in the other byte order as well
+    auto buffer{ adbus::protocol::write_dbus_binary(swapped).value() };
+    auto const length{ std::byteswap(static_cast<std::uint32_t>(swapped.size() * sizeof(std::uint32_t))) };
+    std::memcpy(buffer.data(), &length, sizeof(length));
+    std::vector<std::uint32_t> value{};
+    auto err = read_dbus_binary(value, buffer, other);
+    expect(!err) << fmt::format("error: {}", err);
+    expect(value == expected);
+
+    auto wide_buffer{ adbus::protocol::write_dbus_binary(swapped_wide).value() };
+    auto const wide_length{ std::byteswap(static_cast<std::uint32_t>(swapped_wide.size() * sizeof(std::uint64_t))) };
+    std::memcpy(wide_buffer.data(), &wide_length, sizeof(wide_length));
+    std::vector<std::uint64_t> wide_value{};
+    err = read_dbus_binary(wide_value, wide_buffer, other);
+    expect(!err) << fmt::format("error: {}", err);
+    expect(wide_value == expected_wide);
+
+    // a view would show the bytes unswapped
+    std::span<const std::uint32_t> view{};
+    err = read_dbus_binary(view, buffer, other);
+    expect(err.code == adbus::protocol::error_code::foreign_byte_order);
+  };
+  "header field of the wrong signature"_test = [] {
+    std::vector<std::uint8_t> const buffer{
+      'l', 2, 0, 1,  // endian, method return, flags, version
+      0,   0, 0, 0,  // body length
+      1,   0, 0, 0,  // serial
+      8,   0, 0, 0,  // field array byte length
+      5,             // field code of REPLY_SERIAL
+      1,   's', 0,   // signature, a string instead of UINT32
+      7,   0, 0, 0,  // reply serial
+    };
+    header::header value{};
+    auto const err = read_dbus_binary(value, buffer);
+    expect(err.code == adbus::protocol::error_code::unexpected_variant);
+  };
+  "header with an unknown field holding a container"_test = [] {
+    std::vector<std::uint8_t> const buffer{
+      'l', 2,   0,   1,   // endian, method return, flags, version
+      0,   0,   0,   0,   // body length
+      1,   0,   0,   0,   // serial
+      40,  0,   0,   0,   // field array byte length
+      42,                 // unknown field code
+      5,   'a', '{', 's', 'v', '}', 0,  // signature
+      16,  0,   0,   0,   // byte length of the dictionary
+      0,   0,   0,   0,   // padding to its first entry
+      1,   0,   0,   0,   'k', 0,       // key
+      1,   'u', 0,   0,   // variant signature, padding
+      7,   0,   0,   0,   // variant value
+      5,                  // field code of REPLY_SERIAL
+      1,   'u', 0,        // signature
+      7,   0,   0,   0,   // reply serial
+    };
+    header::header value{};
+    auto err = read_dbus_binary(value, buffer);
+    expect(!err) << fmt::format("error: {}", err);
+    expect(value.fields.size() == 1_u);
+    expect(value.fields == decltype(value.fields){ { header::field_reply_serial{ 7 } } });
+
+    // the dictionary claims a byte more than its entry, the next entry runs past the end
+    auto truncated{ buffer };
+    truncated[24] = 17;
+    err = read_dbus_binary(value, truncated);
+    expect(err.code == adbus::protocol::error_code::out_of_range);
+
+    // not a single complete type
+    auto wrong_signature{ buffer };
+    wrong_signature[18] = 'x';
+    wrong_signature[19] = 'x';
+    err = read_dbus_binary(value, wrong_signature);
+    expect(err.code == adbus::protocol::error_code::invalid_signature);
+  };
 
 
   // todo test the following payload
@@ -690,4 +921,48 @@ int main() {
     auto err = read_dbus_binary(header, buffer);
     expect(!err) << fmt::format("error: {}", err);
   };
+
+  "decode into a memory resource"_test = [] {
+    auto const expected{ adbus::protocol::methods::hello() };
+    auto const buffer{ adbus::protocol::write_dbus_binary(expected).value() };
+    header::header const with_signature{ .type = header::message_type_e::method_return,
+                                         .serial = 2,
+                                         .fields = { { header::field_reply_serial{ 1 } },
+                                                     { header::field_signature{ std::string_view{
+                                                         "(ta(st)a(st)s)a{sv}a{sa{sv}}" } } } } };
+    auto const signature_buffer{ adbus::protocol::write_dbus_binary(with_signature).value() };
+
+    counting_resource default_resource{};
+    counting_resource upstream{};
+    auto* previous{ std::pmr::set_default_resource(&default_resource) };
+    {
+      std::pmr::monotonic_buffer_resource arena{ &upstream };
+      auto decoded{ adbus::protocol::read_dbus_binary<header::header>(buffer, &arena) };
+      expect(fatal(decoded.has_value()));
+      expect(*decoded == expected);
+      expect(decoded->fields.get_allocator().resource() == &arena);
+      auto const& path{ std::get<header::field_path>(decoded->fields.front().value).value };
+      expect(path.buffer.get_allocator().resource() == &arena);
+
+      auto const strings_buffer{
+        adbus::protocol::write_dbus_binary(std::vector{ "a string which does not fit SSO"s }).value()
+      };
+      std::pmr::vector<std::pmr::string> strings{ &arena };
+      auto err = adbus::protocol::read_dbus_binary(strings, strings_buffer, std::begin(strings_buffer), &arena);
+      expect(!err);
+      expect(fatal(strings.size() == 1_u));
+      expect(strings.front().get_allocator().resource() == &arena);
+
+      // a body signature too long to be stored inline
+      auto signature_decoded{ adbus::protocol::read_dbus_binary<header::header>(signature_buffer, &arena) };
+      expect(fatal(signature_decoded.has_value()));
+      expect(*signature_decoded == with_signature);
+      auto const& signature{ std::get<header::field_signature>(signature_decoded->fields.back().value).value };
+      expect(std::string_view{ signature } == "(ta(st)a(st)s)a{sv}a{sa{sv}}"sv);
+      expect(signature.get_allocator().resource() == &arena);
+    }
+    std::pmr::set_default_resource(previous);
+    expect(default_resource.allocations == 0_u);
+    expect(upstream.allocations > 0_u);
+  };
 }
@@ -0,0 +1,78 @@
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <thread>
+#include <vector>
+
+#include <boost/ut.hpp>
+
+#include <adbus/core/serial_counter.hpp>
+
+using namespace boost::ut;
+
+int main() {
+  using adbus::serial_block;
+  using adbus::serial_counter;
+  constexpr auto max{ std::numeric_limits<std::uint32_t>::max() };
+
+  "serials start at one"_test = [] {
+    serial_counter counter{};
+    expect(counter.next() == 1_u);
+    expect(counter.next() == 2_u);
+    auto const block{ counter.reserve(3) };
+    expect(block.first == 3_u && block.size() == 3_u);
+    expect(block[2] == 5_u);
+    expect(counter.next() == 6_u);
+    expect(counter.reserve(0).empty());
+  };
+
+  "zero is skipped when wrapping around"_test = [max] {
+    serial_counter counter{ max - 1 };
+    expect(counter.next() == max);
+    expect(counter.next() == 1_u);
+
+    serial_counter block_counter{ max - 2 };
+    auto const block{ block_counter.reserve(4) };  // max - 1, max, 0 and 1 would contain zero
+    expect(block.first == 1_u && block.size() == 4_u);
+    expect(!block.contains(0));
+    expect(block_counter.next() == 5_u);
+
+    serial_counter exact{ max - 2 };
+    auto const last_block{ exact.reserve(2) };  // ends exactly at max
+    expect(last_block.first == max - 1);
+    expect(last_block.contains(max));
+    expect(exact.next() == 1_u);
+  };
+
+  "concurrent serials are unique"_test = [] {
+    constexpr std::size_t threads{ 8 };
+    constexpr std::size_t per_thread{ 10'000 };
+    serial_counter counter{};
+    std::vector<std::vector<std::uint32_t>> serials(threads);
+    {
+      std::vector<std::jthread> workers{};
+      for (auto& output : serials) {
+        workers.emplace_back([&counter, &output] {
+          for (std::size_t i{}; i < per_thread; ++i) {
+            if (i % 10 == 0) {
+              auto const block{ counter.reserve(5) };
+              for (std::uint32_t j{}; j < block.size(); ++j) {
+                output.emplace_back(block[j]);
+              }
+            } else {
+              output.emplace_back(counter.next());
+            }
+          }
+        });
+      }
+    }
+    std::vector<std::uint32_t> all{};
+    for (auto const& output : serials) {
+      all.insert(all.end(), output.begin(), output.end());
+    }
+    std::ranges::sort(all);
+    expect(std::ranges::adjacent_find(all) == all.end());
+    expect(all.front() == 1_u);
+    expect(all.back() == all.size());  // no gaps either
+  };
+}
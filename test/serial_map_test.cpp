@@ -0,0 +1,86 @@
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <unordered_map>
+
+#include <boost/ut.hpp>
+
+#include <adbus/core/serial_map.hpp>
+
+using namespace boost::ut;
+
+int main() {
+  using adbus::serial_map;
+
+  "insert find erase"_test = [] {
+    serial_map<int> map{};
+    expect(map.empty());
+    expect(map.insert(1, 10) != nullptr);
+    expect(map.insert(2, 20) != nullptr);
+    expect(map.insert(1, 30) == nullptr);  // already present
+    expect(map.insert(0, 40) == nullptr);  // zero is never a valid serial
+    expect(map.size() == 2_u);
+    expect(fatal(map.find(1) != nullptr));
+    expect(*map.find(1) == 10_i);
+    expect(map.find(3) == nullptr);
+    expect(map.extract(2) == 20);
+    expect(!map.contains(2));
+    expect(map.erase(1));
+    expect(!map.erase(1));
+    expect(map.empty());
+  };
+
+  "colliding serials survive erasing"_test = [] {
+    serial_map<std::uint32_t> map{ 16 };
+    // every serial has the same home slot and the probe sequence wraps around the end of the table
+    std::vector<std::uint32_t> const serials{ 15, 31, 47, 63, 79 };
+    for (auto serial : serials) {
+      expect(map.insert(serial, serial) != nullptr);
+    }
+    expect(map.erase(31));
+    for (auto serial : { 15u, 47u, 63u, 79u }) {
+      expect(map.find(serial) != nullptr && *map.find(serial) == serial) << serial;
+    }
+    expect(map.erase(15));
+    expect(map.erase(79));
+    expect(map.find(47) != nullptr && map.find(63) != nullptr);
+    expect(map.size() == 2_u);
+  };
+
+  "move only values"_test = [] {
+    serial_map<std::unique_ptr<int>> map{};
+    for (std::uint32_t serial{ 1 }; serial <= 100; ++serial) {
+      map.insert(serial, std::make_unique<int>(static_cast<int>(serial)));
+    }
+    auto value{ map.extract(42) };
+    expect(fatal(value.has_value()));
+    expect(**value == 42_i);
+    expect(map.size() == 99_u);
+  };
+
+  "matches a reference map"_test = [] {
+    std::mt19937 rng{ 1337 };
+    serial_map<std::uint32_t> map{};
+    std::unordered_map<std::uint32_t, std::uint32_t> reference{};
+    std::uint32_t next_serial{ 1 };
+    for (std::size_t i{}; i < 100'000; ++i) {
+      // mostly monotonic serials as handed out by a connection, with replies arriving in random order
+      if (reference.size() < 1000 && (rng() % 3 != 0 || reference.empty())) {
+        auto const serial{ next_serial++ };
+        map.insert(serial, serial * 2);
+        reference.emplace(serial, serial * 2);
+      } else {
+        auto const serial{ next_serial - 1 - static_cast<std::uint32_t>(rng() % (next_serial - 1)) };
+        auto const expected{ reference.erase(serial) == 1 };
+        expect(map.erase(serial) == expected);
+      }
+    }
+    expect(map.size() == reference.size());
+    for (auto const& [serial, value] : reference) {
+      expect(map.find(serial) != nullptr && *map.find(serial) == value);
+    }
+    std::size_t visited{};
+    map.for_each([&](auto, auto) { ++visited; });
+    expect(visited == reference.size());
+  };
+}
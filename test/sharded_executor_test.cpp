@@ -0,0 +1,44 @@
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <boost/asio.hpp>
+#include <boost/ut.hpp>
+
+#include <adbus/core/sharded_executor.hpp>
+
+using namespace boost::ut;
+namespace asio = boost::asio;
+
+int main() {
+  "a key maps to one shard"_test = [] {
+    asio::io_context ctx{};
+    adbus::sharded_executor<> workers{ ctx.get_executor(), 8 };
+    expect(workers.size() == 8_u);
+    expect(&workers.shard_of("/org/example/A") == &workers.shard_of("/org/example/A"));
+    // at least one shard
+    adbus::sharded_executor<> single{ ctx.get_executor(), 0 };
+    expect(single.size() == 1_u);
+  };
+
+  "work of a key runs in order"_test = [] {
+    constexpr std::size_t keys{ 4 };
+    constexpr std::size_t per_key{ 1000 };
+    asio::thread_pool pool{ 4 };
+    adbus::sharded_executor<asio::thread_pool::executor_type> workers{ pool.get_executor(), 16 };
+    // every key only touches its own vector, on its own strand
+    std::vector<std::vector<std::size_t>> seen(keys);
+    for (std::size_t idx{}; idx < per_key; ++idx) {
+      for (std::size_t key{}; key < keys; ++key) {
+        workers.post("/org/example/" + std::to_string(key), [&seen, key, idx] { seen[key].push_back(idx); });
+      }
+    }
+    pool.join();
+    for (auto const& values : seen) {
+      expect(fatal(values.size() == per_key));
+      for (std::size_t idx{}; idx < per_key; ++idx) {
+        expect(values[idx] == idx);
+      }
+    }
+  };
+}
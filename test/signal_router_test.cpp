@@ -0,0 +1,233 @@
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fmt/format.h>
+#include <fmt/ranges.h>
+
+#include <boost/ut.hpp>
+
+#include <adbus/core/signal_router.hpp>
+#include <adbus/protocol/header_view.hpp>
+#include <adbus/protocol/match_rule.hpp>
+#include <adbus/protocol/write.hpp>
+
+using namespace boost::ut;
+using std::string_view_literals::operator""sv;
+namespace header = adbus::protocol::header;
+
+struct name_owner_changed {
+  std::string name{};
+  std::string old_owner{};
+  std::string new_owner{};
+};
+
+struct signal_message {
+  std::string bytes{};
+  header::header_view view{};
+};
+
+template <typename body_t>
+auto make_signal(std::string_view object_path,
+                 std::string_view interface,
+                 std::string_view member,
+                 body_t const& body,
+                 std::string_view sender = ":1.7") -> signal_message {
+  namespace protocol = adbus::protocol;
+  header::header const hdr{ .type = header::message_type_e::signal,
+                            .serial = 1,
+                            .fields = {
+                                { header::field_path{ protocol::path::make(object_path).value() } },
+                                { header::field_interface{ protocol::interface_name::make(interface).value() } },
+                                { header::field_member{ protocol::member_name::make(member).value() } },
+                                { header::field_sender{ std::pmr::string{ sender } } },
+                                { header::field_signature{ protocol::type::signature_v<body_t> } },
+                            } };
+  signal_message output{ .bytes = protocol::write_dbus_message(hdr, body).value() };
+  output.view = header::header_view::make(output.bytes).value();
+  return output;
+}
+
+int main() {
+  using adbus::signal_router;
+  using adbus::protocol::match_rule;
+
+  "match rule text"_test = [] {
+    expect(match_rule{}.to_string() == "type='signal'"sv);
+    match_rule const rule{ .sender = "org.freedesktop.DBus",
+                           .path_namespace = "/org/example",
+                           .interface = "org.example.Iface",
+                           .member = "Changed",
+                           .arg0 = "it's" };
+    expect(rule.to_string() ==
+           R"(type='signal',sender='org.freedesktop.DBus',path_namespace='/org/example',interface='org.example.Iface',member='Changed',arg0='it'\''s')"sv)
+        << rule.to_string();
+    expect(match_rule{ .arg0 = "" }.to_string() == "type='signal',arg0=''"sv);
+  };
+
+  "path namespace"_test = [] {
+    expect(match_rule::in_namespace("/a", "/a"));
+    expect(match_rule::in_namespace("/a/b", "/a"));
+    expect(!match_rule::in_namespace("/ab", "/a"));
+    expect(match_rule::in_namespace("/ab", "/"));
+  };
+
+  "dispatch by interface member and path"_test = [] {
+    signal_router router{};
+    std::vector<std::string> calls{};
+    auto record{ [&calls](std::string label) {
+      return [&calls, label](header::header_view const&, std::string const&) { calls.emplace_back(label); };
+    } };
+    router.subscribe<std::string>({ .interface = "org.example.A", .member = "Changed" }, record("exact"));
+    router.subscribe<std::string>({ .interface = "org.example.A" }, record("interface"));
+    router.subscribe<std::string>({ .member = "Changed" }, record("member"));
+    router.subscribe<std::string>({}, record("any"));
+    router.subscribe<std::string>({ .path = "/a/b", .interface = "org.example.A" }, record("path"));
+    router.subscribe<std::string>({ .path_namespace = "/a", .interface = "org.example.A" }, record("namespace"));
+    router.subscribe<std::string>({ .interface = "org.example.B" }, record("other interface"));
+    router.subscribe<std::string>({ .sender = ":1.8" }, record("other sender"));
+    router.subscribe<std::string>({ .arg0 = "value" }, record("arg0"));
+    router.subscribe<std::string>({ .arg0 = "other" }, record("other arg0"));
+
+    auto const signal{ make_signal("/a/b", "org.example.A", "Changed", std::string{ "value" }) };
+    expect(router.dispatch(signal.view) == 7_u);
+    std::ranges::sort(calls);
+    expect(calls == std::vector<std::string>{ "any", "arg0", "exact", "interface", "member", "namespace", "path" })
+        << fmt::format("{}", calls);
+
+    calls.clear();
+    auto const elsewhere{ make_signal("/ab", "org.example.A", "Removed", std::string{ "other" }) };
+    expect(router.dispatch(elsewhere.view) == 3_u);
+    std::ranges::sort(calls);
+    expect(calls == std::vector<std::string>{ "any", "interface", "other arg0" }) << fmt::format("{}", calls);
+  };
+
+  "one decoded body for every subscriber of its type"_test = [] {
+    signal_router router{};
+    std::vector<name_owner_changed const*> seen{};
+    std::size_t strings{};
+    for (int idx{}; idx < 3; ++idx) {
+      router.subscribe<name_owner_changed>(
+          { .interface = "org.freedesktop.DBus", .member = "NameOwnerChanged" },
+          [&seen](header::header_view const&, name_owner_changed const& body) {
+            expect(body.name == "com.example.Name"sv);
+            seen.emplace_back(&body);
+          });
+    }
+    // a subscriber expecting another body is not called
+    router.subscribe<std::string>({ .interface = "org.freedesktop.DBus" },
+                                  [&strings](header::header_view const&, std::string const&) { ++strings; });
+    auto const signal{ make_signal("/org/freedesktop/DBus", "org.freedesktop.DBus", "NameOwnerChanged",
+                                   name_owner_changed{ .name = "com.example.Name", .new_owner = ":1.9" }) };
+    expect(router.dispatch(signal.view) == 3_u);
+    expect(fatal(seen.size() == 3_u));
+    expect(seen[0] == seen[1] && seen[1] == seen[2]);
+    expect(strings == 0_u);
+  };
+
+  "unsubscribe"_test = [] {
+    signal_router router{};
+    std::size_t calls{};
+    auto const counter{ [&calls](header::header_view const&, std::string const&) { ++calls; } };
+    auto const first{ router.subscribe<std::string>({ .path_namespace = "/a", .interface = "org.example.A" }, counter) };
+    auto const second{ router.subscribe<std::string>({ .path = "/a/b" }, counter) };
+    expect(router.size() == 2_u);
+    expect(router.rule(first)->path_namespace == "/a"sv);
+    expect(router.unsubscribe(first));
+    expect(!router.unsubscribe(first));
+    expect(router.rule(first) == nullptr);
+
+    auto const signal{ make_signal("/a/b", "org.example.A", "Changed", std::string{ "value" }) };
+    expect(router.dispatch(signal.view) == 1_u);
+    expect(router.unsubscribe(second));
+    expect(router.dispatch(signal.view) == 0_u);
+    expect(calls == 1_u);
+    expect(router.empty());
+    expect(router.bucket_count() == 0_u);
+  };
+
+  "unsubscribe drops what it leaves empty"_test = [] {
+    signal_router router{};
+    std::size_t calls{};
+    auto const counter{ [&calls](header::header_view const&, std::string const&) { ++calls; } };
+    auto const deep{ router.subscribe<std::string>({ .path_namespace = "/a/b/c", .interface = "org.example.A" },
+                                                   counter) };
+    auto const shallow{ router.subscribe<std::string>({ .path_namespace = "/a", .interface = "org.example.A" },
+                                                      counter) };
+    auto const exact{ router.subscribe<std::string>({ .path = "/a/b", .interface = "org.example.A" }, counter) };
+    auto const other{ router.subscribe<std::string>({ .interface = "org.example.B", .member = "Changed" }, counter) };
+    expect(router.bucket_count() == 2_u);
+
+    // the shallower namespace still matches once the path elements below it are dropped
+    expect(router.unsubscribe(deep));
+    auto const signal{ make_signal("/a/b/c", "org.example.A", "Changed", std::string{ "value" }) };
+    expect(router.dispatch(signal.view) == 1_u);
+    expect(router.unsubscribe(exact));
+    expect(router.unsubscribe(shallow));
+    expect(router.bucket_count() == 1_u);
+    expect(router.dispatch(signal.view) == 0_u);
+
+    expect(router.unsubscribe(other));
+    expect(router.bucket_count() == 0_u);
+    // nothing is looked up for an unknown subscription, let alone created
+    expect(!router.unsubscribe(other));
+    expect(router.bucket_count() == 0_u);
+    expect(calls == 1_u);
+  };
+
+  "callbacks may unsubscribe and subscribe"_test = [] {
+    signal_router router{};
+    // guards the router the way a connection does, held while matching and not while delivering
+    std::mutex mutex{};
+    std::size_t first_calls{};
+    std::size_t second_calls{};
+    std::size_t added_calls{};
+    signal_router::subscription_id first{};
+    signal_router::subscription_id second{};
+    first = router.subscribe<std::string>(
+        { .interface = "org.example.A" }, [&](header::header_view const&, std::string const&) {
+          ++first_calls;
+          std::scoped_lock lock{ mutex };
+          expect(router.unsubscribe(first));
+          expect(router.unsubscribe(second));
+          router.subscribe<std::string>({ .interface = "org.example.A" },
+                                        [&added_calls](header::header_view const&, std::string const&) { ++added_calls; });
+        });
+    second = router.subscribe<std::string>(
+        { .interface = "org.example.A" },
+        [&second_calls](header::header_view const&, std::string const&) { ++second_calls; });
+
+    auto const signal{ make_signal("/a", "org.example.A", "Changed", std::string{ "value" }) };
+    signal_router::matches found{};
+    {
+      std::scoped_lock lock{ mutex };
+      router.match(signal.view, found);
+    }
+    expect(found.size() == 2_u);
+    // both were matched, the one removed by the other still gets this signal
+    expect(signal_router::deliver(signal.view, found) == 2_u);
+    expect(first_calls == 1_u);
+    expect(second_calls == 1_u);
+    expect(added_calls == 0_u);
+    expect(router.size() == 1_u);
+
+    expect(router.dispatch(signal.view) == 1_u);
+    expect(first_calls == 1_u);
+    expect(added_calls == 1_u);
+  };
+
+  "many subscriptions"_test = [] {
+    signal_router router{};
+    std::size_t calls{};
+    for (int idx{}; idx < 2000; ++idx) {
+      router.subscribe<std::string>({ .interface = "org.example.A", .member = fmt::format("Member{}", idx) },
+                                    [&calls](header::header_view const&, std::string const&) { ++calls; });
+    }
+    auto const signal{ make_signal("/a", "org.example.A", "Member1234", std::string{ "value" }) };
+    expect(router.dispatch(signal.view) == 1_u);
+    expect(calls == 1_u);
+  };
+}
@@ -1,6 +1,7 @@
 #include <array>
 #include <cstdint>
 #include <map>
+#include <memory_resource>
 #include <unordered_map>
 #include <set>
 #include <tuple>
@@ -110,6 +111,10 @@ using foo_t = glz::detail::Object<glz::tuplet::tuple<glz::tuplet::tuple<std::bas
 static_assert(glz::detail::glaze_object_t<my_struct3>);
 static_assert(signature_v<my_struct3> == "(isy(is))"sv, join_v<chars<"got: \"">, signature_v<my_struct3>, chars<"\" expected: \"(isy(is))\"">>);
 
+// a decoded signature takes its overflow storage from the resource of the message
+static_assert(std::uses_allocator_v<adbus::protocol::type::signature, std::pmr::polymorphic_allocator<>>);
+static_assert(sizeof(adbus::protocol::type::signature) < 64);
+
 // from common.hpp
 static_assert(signature_v<enum_as_number> == "y"sv);
 static_assert(signature_v<enum_as_string> == "s"sv);
@@ -0,0 +1,121 @@
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <boost/asio.hpp>
+#include <boost/ut.hpp>
+
+#include <adbus/core/sharded_executor.hpp>
+#include <adbus/core/write_queue.hpp>
+
+using namespace boost::ut;
+namespace asio = boost::asio;
+using socket_t = asio::local::stream_protocol::socket;
+
+namespace {
+
+// A frame is its total size, its sender and index, then bytes derived from all three
+auto make_frame(std::uint32_t sender, std::uint32_t index, std::size_t size) -> std::string {
+  std::string output(size, '\0');
+  auto const length{ static_cast<std::uint32_t>(size) };
+  std::memcpy(output.data(), &length, sizeof(length));
+  std::memcpy(output.data() + 4, &sender, sizeof(sender));
+  std::memcpy(output.data() + 8, &index, sizeof(index));
+  for (std::size_t idx{ 12 }; idx < size; ++idx) {
+    output[idx] = static_cast<char>((sender * 31 + index * 7 + idx) & 0xff);
+  }
+  return output;
+}
+
+}  // namespace
+
+int main() {
+  "messages are written in order"_test = [] {
+    asio::io_context ctx{};
+    socket_t writer{ ctx };
+    socket_t reader{ ctx };
+    asio::local::connect_pair(writer, reader);
+    adbus::write_queue<socket_t> queue{ writer };
+    std::vector<std::string> const messages{ "first", std::string(1 << 20, 'x'), "third" };
+    std::vector<std::size_t> completed{};
+    for (std::size_t idx{}; idx < messages.size(); ++idx) {
+      queue.async_write({ asio::buffer(messages[idx]) }, [&completed, idx](std::error_code err, std::size_t) {
+        expect(!err);
+        completed.push_back(idx);
+      });
+    }
+    std::string received{};
+    std::jthread drain{ [&] {
+      std::string chunk(64 * 1024, '\0');
+      boost::system::error_code err{};
+      while (received.size() < messages[0].size() + messages[1].size() + messages[2].size()) {
+        received.append(chunk.data(), reader.read_some(asio::buffer(chunk), err));
+      }
+    } };
+    ctx.run();
+    drain.join();
+    expect(received == messages[0] + messages[1] + messages[2]);
+    expect(completed == std::vector<std::size_t>{ 0, 1, 2 });
+  };
+
+  "replies from shards keep their framing"_test = [] {
+    constexpr std::uint32_t senders{ 8 };
+    constexpr std::uint32_t per_sender{ 100 };
+    asio::thread_pool pool{ 4 };
+    // the connection strand as set up for a multi-threaded connection, see sharded_executor
+    socket_t writer{ asio::make_strand(pool) };
+    asio::io_context reader_ctx{};
+    socket_t reader{ reader_ctx };
+    {
+      socket_t writer_end{ pool };
+      asio::local::connect_pair(writer_end, reader);
+      writer.assign(asio::local::stream_protocol{}, writer_end.release());
+    }
+    adbus::write_queue<socket_t> queue{ writer };
+    adbus::sharded_executor<asio::thread_pool::executor_type> workers{ pool.get_executor(), senders };
+    std::atomic<std::uint32_t> failed{};
+    for (std::uint32_t sender{}; sender < senders; ++sender) {
+      workers.post(std::to_string(sender), [&queue, &failed, sender] {
+        for (std::uint32_t index{}; index < per_sender; ++index) {
+          // large enough for the writes to be split into partial writes
+          auto const size{ 12 + (sender * 7919 + index * 104729) % 300'000 };
+          auto frame{ std::make_shared<std::string>(make_frame(sender, index, size)) };
+          queue.async_write({ asio::buffer(*frame) }, [frame, &failed](std::error_code err, std::size_t) {
+            if (err) {
+              ++failed;
+            }
+          });
+        }
+      });
+    }
+
+    // every frame is whole and the frames of one sender arrive in the order they were queued
+    std::vector<std::uint32_t> next(senders);
+    std::size_t frames{};
+    std::string header(12, '\0');
+    while (frames < senders * per_sender) {
+      asio::read(reader, asio::buffer(header));
+      std::uint32_t length{};
+      std::uint32_t sender{};
+      std::uint32_t index{};
+      std::memcpy(&length, header.data(), sizeof(length));
+      std::memcpy(&sender, header.data() + 4, sizeof(sender));
+      std::memcpy(&index, header.data() + 8, sizeof(index));
+      expect(fatal(sender < senders && length >= 12)) << "frame header torn";
+      std::string rest(length - 12, '\0');
+      asio::read(reader, asio::buffer(rest));
+      expect(fatal(header + rest == make_frame(sender, index, length))) << "frame body torn";
+      expect(fatal(index == next[sender])) << "frames of a sender out of order";
+      ++next[sender];
+      ++frames;
+    }
+    pool.join();
+    expect(failed == 0_u);
+  };
+}
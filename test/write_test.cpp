@@ -1,4 +1,7 @@
+#include <algorithm>
 #include <array>
+#include <cstddef>
+#include <span>
 #include <tuple>
 
 #include <fmt/format.h>
@@ -9,6 +12,7 @@
 #include <set>
 #include <unordered_set>
 
+#include <adbus/protocol/gather_buffer.hpp>
 #include <adbus/protocol/methods.hpp>
 #include <adbus/protocol/signature.hpp>
 #include <adbus/protocol/write.hpp>
@@ -195,6 +199,30 @@ int main() {
     expect(std::equal(buffer.begin(), buffer.end(), std::begin(compare), std::end(compare), uint8_cmp));
   };
 
+  "large array of fixed types"_test =
+      [](auto&& value) {
+        using value_t = typename std::decay_t<decltype(value)>::value_type;
+        for (std::size_t offset{}; offset < 8; ++offset) {
+          std::string buffer(offset, '\0');
+          auto err = write_dbus_binary(value, buffer);
+          expect(!err);
+          const auto length_idx{ (offset + 3) / 4 * 4 };
+          const auto data_idx{ (length_idx + 4 + sizeof(value_t) - 1) / sizeof(value_t) * sizeof(value_t) };
+          const auto bytes{ value.size() * sizeof(value_t) };
+          expect(buffer.size() == data_idx + bytes) << fmt::format("Expected: {}, Got: {}", data_idx + bytes, buffer.size());
+          std::uint32_t n{};
+          std::memcpy(&n, buffer.data() + length_idx, sizeof(n));
+          expect(n == bytes);
+          expect(std::memcmp(buffer.data() + data_idx, value.data(), bytes) == 0);
+        }
+      } |
+      std::tuple{
+        std::vector<double>(4099, 1337.42),
+        std::vector<std::uint8_t>(100001, 0x42),
+        std::vector<std::int16_t>(513, -0x1234),
+        std::array<std::uint32_t, 7>{ 1, 2, 3, 4, 5, 6, 7 },
+      };
+
   "vector of strings"_test =
       [](auto&& value) {
         std::string buffer{};
@@ -578,6 +606,184 @@ int main() {
     expect(std::equal(buffer.begin(), buffer.end(), compare.begin(), compare.end(), uint8_cmp));
   };
 
+  "dbus_size matches the written size"_test =
+      [](auto&& value) {
+        for (std::size_t offset{}; offset < 8; ++offset) {
+          std::string buffer(offset, '\0');
+          auto err = write_dbus_binary(value, buffer);
+          expect(!err);
+          const auto size{ adbus::protocol::dbus_size(value, offset) };
+          expect(buffer.size() - offset == size)
+              << fmt::format("Expected: {}, Got: {} for offset: {}", buffer.size() - offset, size, offset);
+        }
+      } |
+      std::tuple{
+        std::uint8_t{ 42 },
+        true,
+        1337.42,
+        enum_as_string::b,
+        "this is a message"s,
+        std::vector<std::uint64_t>{},
+        std::vector<std::uint16_t>{ 1, 2, 3 },
+        std::vector{ "hello"s, "dbus"s, "world"s },
+        std::vector<std::vector<std::uint64_t>>{ { 1, 2 }, { 3, 4, 5 } },
+        simple{},
+        foo{ .a = 12345,
+             .bars = { { "example1", 67890 }, { "example2", 13579 } },
+             .bars2 = { { "example3", 24680 } },
+             .b = "end" },
+        std::map<std::string, std::map<std::string, std::uint64_t>>{ { "outerKey", { { "innerKey", 789 } } } },
+        std::variant<std::string, std::int32_t, double>{ 1337.42 },
+        adbus::protocol::methods::hello(),
+      };
+  static_assert(adbus::protocol::dbus_fixed_size_v<std::uint64_t> == 8);
+
+  "fixed capacity buffer"_test =
+      [](auto&& value) {
+        auto expected = adbus::protocol::write_dbus_binary(value);
+        expect(fatal(expected.has_value()));
+        std::array<std::byte, 512> storage{};
+        std::size_t idx{};
+        auto err = write_dbus_binary(value, storage, idx);
+        expect(!err);
+        expect(idx == expected->size()) << fmt::format("Expected: {}, Got: {}", expected->size(), idx);
+        expect(std::equal(expected->begin(), expected->end(), storage.begin(), storage.begin() + idx, uint8_cmp));
+
+        // Every capacity short of the full message must be rejected without writing past the end of the span
+        for (std::size_t capacity{}; capacity < expected->size(); ++capacity) {
+          std::span<std::byte> slot{ storage.data(), capacity };
+          err = write_dbus_binary(value, slot);
+          expect(err.code == adbus::protocol::error_code::buffer_too_small)
+              << fmt::format("Expected buffer_too_small for capacity: {}", capacity);
+        }
+      } |
+      std::tuple{
+        std::uint64_t{ 0x1234 },
+        "this is a message"s,
+        std::vector<std::uint16_t>{ 1, 2, 3 },
+        std::vector{ "hello"s, "dbus"s, "world"s },
+        foo{ .a = 12345,
+             .bars = { { "example1", 67890 }, { "example2", 13579 } },
+             .bars2 = { { "example3", 24680 } },
+             .b = "end" },
+        std::variant<std::string, std::int32_t, double>{ "variant"s },
+        adbus::protocol::methods::hello(),
+      };
+
+  "message header and body in one buffer"_test = [] {
+    using namespace adbus::protocol::header;
+    using adbus::protocol::write_dbus_message;
+    header hdr{ .type = message_type_e::method_call,
+                .serial = 42,
+                .fields = { { field_path{ adbus::protocol::path::make("/org/freedesktop/DBus").value() } },
+                            { field_member{ "RequestName" } },
+                            { field_signature{ std::string_view{ "(ta(st)a(st)s)" } } } } };
+    foo const body{ .a = 12345,
+                    .bars = { { "example1", 67890 }, { "example2", 13579 } },
+                    .bars2 = { { "example3", 24680 } },
+                    .b = "end" };
+    auto message = write_dbus_message(hdr, body);
+    expect(fatal(message.has_value()));
+    expect(hdr.body_length == 0_u);  // the given header is not modified
+
+    // the same message serialized in two steps
+    auto body_buffer = adbus::protocol::write_dbus_binary(body);
+    expect(fatal(body_buffer.has_value()));
+    hdr.body_length = static_cast<std::uint32_t>(body_buffer->size());
+    auto expected = adbus::protocol::write_dbus_binary(hdr);
+    expect(fatal(expected.has_value()));
+    expected->append(*body_buffer);
+    expect(*message == *expected);
+
+    std::array<std::byte, 512> storage{};
+    auto err = write_dbus_message(hdr, body, storage);
+    expect(!err);
+    expect(std::equal(expected->begin(), expected->end(), storage.begin(), storage.begin() + expected->size(), uint8_cmp));
+
+    auto no_body = write_dbus_message(adbus::protocol::methods::hello(), glz::skip{});
+    expect(fatal(no_body.has_value()));
+    expect(*no_body == adbus::protocol::write_dbus_binary(adbus::protocol::methods::hello()).value());
+  };
+
+  "gather buffer references large payloads"_test = [] {
+    struct payload {
+      std::string small{ "small" };
+      std::string large = std::string(64, 'x');
+      std::vector<std::uint64_t> numbers = std::vector<std::uint64_t>(8, 42);
+      std::vector<std::uint8_t> bytes = std::vector<std::uint8_t>(3, 1);
+    };
+    payload const value{};
+    auto expected = adbus::protocol::write_dbus_binary(value);
+    expect(fatal(expected.has_value()));
+
+    adbus::protocol::gather_buffer buffer{ 16 };
+    auto err = write_dbus_binary(value, buffer);
+    expect(!err);
+    expect(buffer.size() == expected->size());
+    expect(buffer.flatten() == *expected);
+
+    // framing, large string, framing, numbers, framing
+    auto segments = buffer.buffers();
+    expect(fatal(segments.size() == 5_u));
+    expect(segments[1].data() == static_cast<const void*>(value.large.data()));
+    expect(segments[1].size() == value.large.size());
+    expect(segments[3].data() == static_cast<const void*>(value.numbers.data()));
+
+    using namespace adbus::protocol::header;
+    header const hdr{ .type = message_type_e::method_call,
+                      .serial = 7,
+                      .fields = { { field_signature{ std::string_view{ "(ssatay)" } } } } };
+    auto message = adbus::protocol::write_dbus_message(hdr, value);
+    expect(fatal(message.has_value()));
+    err = write_dbus_message(hdr, value, buffer);
+    expect(!err);
+    expect(buffer.flatten() == *message);
+  };
+
+  "outgoing message does not copy its params"_test = [] {
+    struct counted {
+      std::size_t* copies{};
+      explicit counted(std::size_t* count) : copies{ count } {}
+      counted(counted const& other) : copies{ other.copies } { ++*copies; }
+      counted(counted&&) noexcept = default;
+    };
+    std::size_t copies{};
+    counted lvalue{ &copies };
+    auto const referenced{ adbus::protocol::make_outgoing_message(lvalue) };
+    expect(&referenced->params == &lvalue);
+    auto const moved{ adbus::protocol::make_outgoing_message(counted{ &copies }) };
+    expect(moved->params.copies == &copies);
+    expect(copies == 0_u);
+
+    // the large payload is sent from the string of the caller
+    std::string const large(adbus::protocol::gather_buffer::default_threshold, 'x');
+    auto const message{ adbus::protocol::make_outgoing_message(large) };
+    using namespace adbus::protocol::header;
+    header const hdr{ .type = message_type_e::method_call,
+                      .serial = 7,
+                      .fields = { { field_signature{ std::string_view{ "s" } } } } };
+    expect(!write_dbus_message(hdr, message->params, message->buffer));
+    auto const segments{ message->buffer.buffers() };
+    expect(std::ranges::any_of(segments, [&large](auto const& segment) {
+      return segment.data() == static_cast<void const*>(large.data()) && segment.size() == large.size();
+    }));
+    expect(message->buffer.flatten() == adbus::protocol::write_dbus_message(hdr, large).value());
+  };
+
+  "fixed capacity buffer continues at index"_test = [] {
+    std::array<std::uint8_t, 16> buffer{};
+    std::size_t idx{ 1 };
+    auto err = write_dbus_binary(std::uint32_t{ 0x12345678 }, buffer, idx);
+    expect(!err);
+    expect(idx == 8_u);  // 3 bytes of padding before the value
+    expect(buffer[4] == 0x78 && buffer[7] == 0x12);
+    err = write_dbus_binary(std::uint64_t{ 42 }, buffer, idx);
+    expect(!err);
+    expect(idx == 16_u);
+    err = write_dbus_binary(std::uint8_t{ 1 }, buffer, idx);
+    expect(err.code == adbus::protocol::error_code::buffer_too_small);
+  };
+
   "alignment or padding"_test =
       [](auto test) {
         std::string buffer{};